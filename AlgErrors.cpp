@@ -34,7 +34,7 @@ Errors::Errors(QObject *parent, bool threadExclusive) :
 void Errors::error(Errors::Source s, const SynTree* st, const QString& msg)
 {
     Q_ASSERT( st != 0 );
-    error( s, st->d_tok.d_sourcePath, st->d_tok.d_lineNr, st->d_tok.d_colNr, msg );
+    error( s, st->d_tok.sourcePath(), st->d_tok.d_lineNr, st->d_tok.d_colNr, msg );
 }
 
 void Errors::error(Errors::Source s, const QString& file, int line, int col, const QString& msg)
@@ -69,7 +69,7 @@ void Errors::error(Errors::Source s, const QString& file, int line, int col, con
 void Errors::warning(Errors::Source s, const SynTree* st, const QString& msg)
 {
     Q_ASSERT( st != 0 );
-    warning( s, st->d_tok.d_sourcePath, st->d_tok.d_lineNr, st->d_tok.d_colNr, msg );
+    warning( s, st->d_tok.sourcePath(), st->d_tok.d_lineNr, st->d_tok.d_colNr, msg );
 }
 
 void Errors::warning(Errors::Source s, const QString& file, int line, int col, const QString& msg)
@@ -38,7 +38,7 @@ namespace Alg
         struct Entry
         {
             quint32 d_line;
-            quint16 d_col;
+            quint32 d_col;
             quint16 d_source;
             QString d_msg;
             QString d_file;
@@ -0,0 +1,160 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "AlgFlatTree.h"
+using namespace Alg;
+
+void FlatTree::build(const SynTree* root)
+{
+    clear();
+    if( root == 0 )
+        return;
+
+    struct Frame
+    {
+        const SynTree* d_next; // next child to visit
+        int d_index;
+        int d_last; // index of the child visited last
+    };
+    QVector<Frame> stack;
+    Frame top;
+    top.d_next = root->d_children.first();
+    top.d_index = add( root, -1 );
+    top.d_last = -1;
+    stack.append( top );
+    while( !stack.isEmpty() )
+    {
+        Frame& f = stack.last();
+        if( f.d_next == 0 )
+        {
+            stack.removeLast();
+            continue;
+        }
+        const SynTree* sub = f.d_next;
+        f.d_next = sub->d_next;
+        const int index = add( sub, f.d_index );
+        if( f.d_last != -1 )
+            d_nextSiblings[f.d_last] = index;
+        f.d_last = index;
+        if( !sub->d_children.isEmpty() )
+        {
+            Frame s;
+            s.d_next = sub->d_children.first();
+            s.d_index = index;
+            s.d_last = -1;
+            stack.append( s ); // invalidates f
+        }
+    }
+    assignPending( 0 );
+    d_pending.squeeze();
+}
+
+void FlatTree::clear()
+{
+    d_types.clear();
+    d_tokenIndex.clear();
+    d_parents.clear();
+    d_nextSiblings.clear();
+    d_childCounts.clear();
+    d_tokens.clear();
+    d_pending.clear();
+    d_path = QString();
+    d_pathAtom = 0;
+}
+
+int FlatTree::child(int n, int i) const
+{
+    if( i < 0 || i >= d_childCounts[n] )
+        return -1;
+    int c = n + 1;
+    while( i-- > 0 )
+        c = d_nextSiblings[c];
+    return c;
+}
+
+int FlatTree::subtreeEnd(int n) const
+{
+    // the subtree ends where the next sibling of n or of its closest ancestor having one starts
+    while( n != -1 )
+    {
+        if( d_nextSiblings[n] != -1 )
+            return d_nextSiblings[n];
+        n = d_parents[n];
+    }
+    return d_types.size();
+}
+
+int FlatTree::byteSize() const
+{
+    return d_types.size() * ( sizeof(quint16) + 4 * sizeof(qint32) ) + d_tokens.size() * sizeof(Token);
+}
+
+int FlatTree::add(const SynTree* node, int parent)
+{
+    const int index = d_types.size();
+    d_types.append( node->d_tok.d_type );
+    d_parents.append( parent );
+    d_nextSiblings.append( -1 );
+    d_childCounts.append( node->d_children.size() );
+    if( node->d_tok.d_type != Tok_Invalid && node->d_tok.d_type < SynTree::R_First )
+    {
+        d_tokenIndex.append( d_tokens.size() );
+        d_tokens.append( toToken( node->d_tok ) );
+        assignPending( &node->d_tok );
+    }else
+    {
+        // the parser gives a rule the position of its lookahead, which usually is its first terminal
+        d_tokenIndex.append( -1 );
+        Pending p;
+        p.d_index = index;
+        p.d_node = node;
+        d_pending.append( p );
+    }
+    return index;
+}
+
+void FlatTree::assignPending(const SynToken* terminal)
+{
+    // terminal was added last
+    for( int i = 0; i < d_pending.size(); i++ )
+    {
+        const SynToken& own = d_pending[i].d_node->d_tok;
+        if( terminal != 0 && terminal->d_lineNr == own.d_lineNr && terminal->d_colNr == own.d_colNr &&
+                terminal->d_pathAtom == own.d_pathAtom )
+            d_tokenIndex[d_pending[i].d_index] = d_tokens.size() - 1;
+        else
+        {
+            d_tokenIndex[d_pending[i].d_index] = d_tokens.size();
+            d_tokens.append( toToken( own ) );
+        }
+    }
+    d_pending.clear();
+}
+
+Token FlatTree::toToken(const SynToken& t)
+{
+    // the source path is only converted when it changes
+    if( t.d_pathAtom != d_pathAtom )
+    {
+        d_pathAtom = t.d_pathAtom;
+        d_path = t.sourcePath();
+    }
+    return t.toToken( d_path );
+}
@@ -0,0 +1,77 @@
+#ifndef ALGFLATTREE_H
+#define ALGFLATTREE_H
+
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include <QVector>
+#include <Algol/AlgSynTree.h>
+
+namespace Alg
+{
+    class FlatTree
+    {
+        // a SynTree stored as parallel arrays of its nodes in preorder, so a traversal walks contiguous
+        // memory instead of chasing pointers; node 0 is the root, -1 stands for no node.
+        // A rule node refers to the token of the terminal it starts with, of which only the position
+        // belongs to the rule; rule nodes without such a terminal get a token of their own.
+    public:
+        FlatTree():d_pathAtom(0) {}
+        explicit FlatTree( const SynTree* root ):d_pathAtom(0) { build(root); }
+        void build( const SynTree* root ); // iterative, also for deeply nested trees
+        void clear();
+        bool isEmpty() const { return d_types.isEmpty(); }
+        int count() const { return d_types.size(); }
+
+        quint16 type( int n ) const { return d_types[n]; } // TokenType or SynTree::ParserRule
+        bool isTerminal( int n ) const { return d_types[n] != Tok_Invalid && d_types[n] < SynTree::R_First; }
+        int tokenIndex( int n ) const { return d_tokenIndex[n]; }
+        const Token& token( int n ) const { return d_tokens[d_tokenIndex[n]]; }
+        int parent( int n ) const { return d_parents[n]; }
+        int firstChild( int n ) const { return d_childCounts[n] ? n + 1 : -1; }
+        int nextSibling( int n ) const { return d_nextSiblings[n]; }
+        int childCount( int n ) const { return d_childCounts[n]; }
+        int child( int n, int i ) const; // walks the siblings
+        int subtreeEnd( int n ) const; // the nodes of the subtree of n are [n, subtreeEnd(n))
+
+        const QVector<Token>& tokens() const { return d_tokens; }
+        int byteSize() const; // of the arrays, not counting the values the tokens share with the lexer
+    private:
+        int add( const SynTree* node, int parent );
+        void assignPending( const SynToken* terminal );
+        Token toToken( const SynToken& );
+        QVector<quint16> d_types;
+        QVector<qint32> d_tokenIndex;
+        QVector<qint32> d_parents;
+        QVector<qint32> d_nextSiblings;
+        QVector<qint32> d_childCounts;
+        QVector<Token> d_tokens;
+        struct Pending
+        {
+            int d_index;
+            const SynTree* d_node;
+        };
+        QVector<Pending> d_pending; // rule nodes waiting for their first terminal during build
+        QString d_path; // of the token converted last during build
+        Symbols::Atom d_pathAtom;
+    };
+}
+
+#endif // ALGFLATTREE_H
@@ -18,8 +18,6 @@
 */
 
 #include "AlgHighlighter.h"
-#include "AlgLexer.h"
-#include <QBuffer>
 using namespace Alg;
 
 static const char* s_reserved[] = {
@@ -78,6 +76,9 @@ Highlighter::Highlighter(QTextDocument* parent) :
     d_format[C_Section].setBackground(QColor(230, 255, 230));
 
     d_builtins = createBuiltins(true);
+
+    d_lex.setIgnoreComments(false);
+    d_lex.setPackComments(false);
 }
 
 void Highlighter::setEnableExt(bool b)
@@ -112,8 +113,6 @@ QSet<QByteArray> Highlighter::createBuiltins(bool withLowercase)
 
 void Highlighter::highlightBlock(const QString& text)
 {
-    static const QRegExp commentEnd("\\b(end|END|else|ELSE)\\b|;"); // any sequence not containing 'end' or ';' or 'else'
-
     const int previousBlockState_ = previousBlockState();
     int lexerState = 0, initialBraceDepth = 0;
     if (previousBlockState_ != -1) {
@@ -123,56 +122,29 @@ void Highlighter::highlightBlock(const QString& text)
 
     int braceDepth = initialBraceDepth;
 
+    // the lexer resumes in the comment mode and quoted keyword mode left by the previous block
+    d_lex.setBuffer( text.constData(), text.size() );
+    LexerState state = LexerState::fromFlags( lexerState );
+    if( d_lex.dialect() == Lexer::QuotedKeywords )
+        state.d_quotedKeywords = true;
+    d_lex.restart( state );
 
-    int start = 0;
-    if( lexerState > 0 )
+    QList<Token> tokens;
+    Token tok = d_lex.nextToken();
+    while( !tok.isEof() )
     {
-        // wir sind in einem Multi Line Comment
-        // suche das Ende
-        QTextCharFormat f = formatForCategory(C_Cmt);
-        f.setProperty( TokenProp, int(Tok_Comment) );
-        int pos = lexerState == 1 ? text.indexOf(";") : text.indexOf(commentEnd);
-        if( pos == -1 )
-        {
-            // the whole block ist part of the comment
-            setFormat( start, text.size(), f );
-            setCurrentBlockState( (braceDepth << 8) | lexerState);
-            return;
-        }else
-        {
-            // End of Comment found; semi is not part of comment
-            setFormat( start, pos , f );
-            lexerState = 0;
-            braceDepth--;
-            start = pos;
-        }
+        tokens << tok;
+        tok = d_lex.nextToken();
     }
-
-
-    Alg::Lexer lex;
-    lex.setIgnoreComments(false);
-    lex.setPackComments(false);
-
-    QList<Token> tokens =  lex.tokens(text.mid(start));
     for( int i = 0; i < tokens.size(); ++i )
     {
-        Token &t = tokens[i];
-        t.d_colNr += start;
+        const Token &t = tokens[i];
 
         QTextCharFormat f;
         if( t.d_type == Tok_Comment )
         {
             f = formatForCategory(C_Cmt);
-            if( i == tokens.size() - 1 )
-            {
-                // enable multi line comment
-                // if there is another token following the comment then it cannot be multi line
-                braceDepth++;
-                if( i > 0 && tokens[i-1].d_type == Tok_COMMENT )
-                    lexerState = 1;
-                else
-                    lexerState = 2; // after end comment
-            }
+            f.setProperty( TokenProp, int(Tok_Comment) );
         }/*else if( t.d_type == Tok_Semi && lexerState > 0 )
         {
             // not needed
@@ -201,10 +173,18 @@ void Highlighter::highlightBlock(const QString& text)
 
         if( f.isValid() )
         {
-            setFormat( t.d_colNr-1, t.d_len, f );
+            setFormat( t.d_offset, t.d_byteLen, f ); // QChar span of the token in text, including underlines
         }
     }
 
+    // multi line comments count as braces
+    const LexerState end = d_lex.state();
+    if( end.d_mode != LexerState::Normal && ( lexerState & 3 ) == LexerState::Normal )
+        braceDepth++;
+    else if( end.d_mode == LexerState::Normal && ( lexerState & 3 ) != LexerState::Normal )
+        braceDepth--;
+    lexerState = end.flags();
+
     setCurrentBlockState((braceDepth << 8) | lexerState );
 }
 
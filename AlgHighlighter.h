@@ -22,6 +22,7 @@
 
 #include <QSyntaxHighlighter>
 #include <QSet>
+#include <Algol/AlgLexer.h>
 
 namespace Alg
 {
@@ -43,6 +44,7 @@ namespace Alg
         enum Category { C_Num, C_Str, C_Kw, C_Type, C_Ident, C_Op, C_Pp, C_Cmt, C_Section, C_Brack, C_Max };
         QTextCharFormat d_format[C_Max];
         QSet<QByteArray> d_builtins;
+        Lexer d_lex;
         bool d_enableExt; // Allow for both uppercase and lowercase keywords and for idents with underscores as in C
     };
 }
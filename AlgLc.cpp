@@ -5,9 +5,11 @@
 #include <QDir>
 #include <QElapsedTimer>
 #include <QThread>
+#include <QScopedPointer>
 #include "AlgErrors.h"
 #include "AlgParser.h"
 #include "AlgLexer.h"
+#include "AlgTokenCache.h"
 
 static QStringList collectFiles( const QDir& dir )
 {
@@ -37,7 +39,7 @@ static void dumpTree( Alg::SynTree* node, int level = 0)
         if( Alg::tokenTypeIsKeyword( node->d_tok.d_type ) )
             str = Alg::tokenTypeString(node->d_tok.d_type);
         else if( node->d_tok.d_type > Alg::TT_Specials )
-            str = QByteArray("\"") + node->d_tok.d_val + QByteArray("\"");
+            str = QByteArray("\"") + node->d_tok.value() + QByteArray("\"");
         else
             str = QByteArray("\"") + node->d_tok.getString() + QByteArray("\"");
 
@@ -58,20 +60,26 @@ static void dumpTree( Alg::SynTree* node, int level = 0)
         dumpTree( sub, level + 1 );
 }
 
-class Lex : public Alg::Scanner
+template<class S>
+static bool parse( S* scanner, bool elide, bool dump )
 {
-public:
-    Alg::Lexer lex;
-    Alg::Token next()
+    // with S = Lexer the parser fetches the tokens without virtual calls
+    Alg::ParserT<S> p( scanner );
+    p.elideChains = elide;
+    p.RunParser();
+    const bool ok = p.errors.isEmpty();
+    if( !ok )
     {
-        return lex.nextToken();
-    }
+        foreach( const Alg::ParserError& e, p.errors )
+            qCritical() << e.path << e.row << e.col << e.msg;
+            // qCritical() << fs.findFile(e.path)->getVirtualPath() << e.row << e.col << e.msg;
 
-    Alg::Token peek(int offset)
-    {
-        return lex.peekToken(offset);
-    }
-};
+    }else
+        qDebug() << "ok";
+    if( dump )
+        dumpTree( &p.root );
+    return ok;
+}
 
 int main(int argc, char *argv[])
 {
@@ -90,18 +98,22 @@ int main(int argc, char *argv[])
     bool dump = false;
     QString ns;
     QString mod;
+    QString cachePath;
+    bool elide = false;
     const QStringList args = QCoreApplication::arguments();
     for( int i = 1; i < args.size(); i++ ) // arg 0 enthaelt Anwendungspfad
     {
         if(  args[i] == "-h" || args.size() == 1 )
         {
             out << "usage: AlgLc [options] sources" << endl;
-            out << "  reads Algol60 sources (files or directories) and translates them to corresponding Lua code." << endl;
+            out << "  reads Algol60 sources (files or directories, or - for stdin) and translates them to corresponding Lua code." << endl;
             out << "options:" << endl;
             out << "  -dst      dump syntax trees to files" << endl;
             out << "  -o=path   path where to save generated files (default like first source)" << endl;
             out << "  -ns=name  namespace for the generated files (default empty)" << endl;
             out << "  -mod=name directory of the generated files (default empty)" << endl;
+            out << "  -cache=dir directory where the tokens of the sources are cached" << endl;
+            out << "  -elide    leave out expression and statement rules with only one child" << endl;
             out << "  -h        display this information" << endl;
             return 0;
         }else if( args[i] == "-dst" )
@@ -112,7 +124,11 @@ int main(int argc, char *argv[])
             ns = args[i].mid(4);
         else if( args[i].startsWith("-mod=") )
             mod = args[i].mid(5);
-        else if( !args[ i ].startsWith( '-' ) )
+        else if( args[i].startsWith("-cache=") )
+            cachePath = args[i].mid(7);
+        else if( args[i] == "-elide" )
+            elide = true;
+        else if( !args[ i ].startsWith( '-' ) || args[ i ] == "-" )
         {
             dirOrFilePaths += args[ i ];
         }else
@@ -130,6 +146,13 @@ int main(int argc, char *argv[])
     QStringList files;
     foreach( const QString& path, dirOrFilePaths )
     {
+        if( path == "-" )
+        {
+            if( outPath.isEmpty() )
+                outPath = QDir::currentPath();
+            files << path;
+            continue;
+        }
         QFileInfo info(path);
         if( outPath.isEmpty() )
             outPath = info.isDir() ? info.absoluteFilePath() : info.absolutePath();
@@ -139,6 +162,15 @@ int main(int argc, char *argv[])
             files << path;
     }
 
+    QScopedPointer<Alg::TokenCache> cache;
+    if( !cachePath.isEmpty() )
+    {
+        // unchanged sources are replayed from the cache instead of being lexed again
+        cache.reset( new Alg::TokenCache( cachePath ) );
+        cache->setIgnoreComments(true);
+        cache->setPackComments(true);
+    }
+
     QElapsedTimer timer;
     timer.start();
     int ok = 0;
@@ -146,33 +178,32 @@ int main(int argc, char *argv[])
     {
         qDebug() << "processing" << path;
 
-        Lex lex;
-        lex.lex.setStream(path);
-        lex.lex.setIgnoreComments(true);
-        lex.lex.setPackComments(true);
+        QFile in; // outlives the lexer
+        Alg::Lexer lex;
+        QScopedPointer<Alg::TokenStream> cached;
+        if( cache && path != "-" )
+            cached.reset( cache->tokens( path ) );
+        if( path == "-" )
+        {
+            // the lexer reads pipes and other devices it doesn't own through a fixed window
+            in.open( stdin, QIODevice::ReadOnly );
+            lex.setStream( &in, "stdin" );
+        }else if( !cached )
+            lex.setStream(path);
+        lex.setIgnoreComments(true);
+        lex.setPackComments(true);
     #if 0
-        Alg::Token t = lex.lex.nextToken();
+        Alg::Token t = lex.nextToken();
         while( t.isValid() )
         {
             qDebug() << t.getString() << QString::fromUtf8(t.d_val);
-            t = lex.lex.nextToken();
+            t = lex.nextToken();
         }
     #else
-        Alg::Parser p(&lex);
-        p.RunParser();
-        if( !p.errors.isEmpty() )
-        {
-            foreach( const Alg::Parser::Error& e, p.errors )
-                qCritical() << e.path << e.row << e.col << e.msg;
-                // qCritical() << fs.findFile(e.path)->getVirtualPath() << e.row << e.col << e.msg;
-
-        }else
-        {
+        const bool res = cached ? parse( static_cast<Alg::Scanner*>( cached.data() ), elide, dump ) :
+                                  parse( &lex, elide, dump );
+        if( res )
             ok++;
-            qDebug() << "ok";
-        }
-        if( dump )
-            dumpTree( &p.root );
     #endif
 
     }
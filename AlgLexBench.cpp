@@ -0,0 +1,699 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QTextStream>
+#include <QtDebug>
+#include <QRunnable>
+#include <QThreadPool>
+#include "AlgLexer.h"
+#include "AlgSymbols.h"
+#include <stdlib.h>
+
+// Measures the lexer on generated sources with controlled properties, or on given files, and reports
+// MB/s, tokens/s and heap allocations per token for each way of running the lexer. With -symbols it
+// measures instead how the lookup of interned symbols scales from one to n threads.
+
+#ifdef __GLIBC__
+// All heap allocations of the process, including the ones of QByteArray and QList which don't go
+// through operator new, are counted by interposing the glibc allocator.
+extern "C" void* __libc_malloc( size_t );
+extern "C" void* __libc_calloc( size_t, size_t );
+extern "C" void* __libc_realloc( void*, size_t );
+extern "C" void __libc_free( void* );
+
+static QAtomicInt s_allocs;
+
+extern "C" void* malloc( size_t n )
+{
+    s_allocs.ref();
+    return __libc_malloc( n );
+}
+
+extern "C" void* calloc( size_t n, size_t size )
+{
+    s_allocs.ref();
+    return __libc_calloc( n, size );
+}
+
+extern "C" void* realloc( void* p, size_t n )
+{
+    s_allocs.ref();
+    return __libc_realloc( p, n );
+}
+
+extern "C" void free( void* p )
+{
+    __libc_free( p );
+}
+
+static int allocCount() { return s_allocs.load(); }
+static const bool s_countAllocs = true;
+#else
+static int allocCount() { return 0; }
+static const bool s_countAllocs = false;
+#endif
+
+struct CorpusSpec
+{
+    QByteArray d_name;
+    double d_idents;   // share of operands which are identifiers instead of numbers
+    double d_comments; // share of the bytes in comments
+    double d_pub;      // share of operators written with the publication symbols, e.g. × instead of *
+    bool d_quoted;     // keywords written as 'BEGIN'
+    int d_lineLen;     // lines are broken at about this number of bytes
+    CorpusSpec( const QByteArray& name = "custom", double idents = 0.5, double comments = 0.05,
+                double pub = 0.0, bool quoted = false, int lineLen = 72 ):
+        d_name(name),d_idents(idents),d_comments(comments),d_pub(pub),d_quoted(quoted),d_lineLen(lineLen){}
+};
+
+class Generator
+{
+public:
+    Generator( const CorpusSpec& spec, quint32 seed ):d_spec(spec),d_state(seed ? seed : 1),d_col(0),
+        d_cmtBytes(0),d_inComment(false)
+    {
+        // a fixed pool, so that the lexer sees repeated identifiers like in real code
+        static const char* s_letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        for( int i = 0; i < 500; i++ )
+        {
+            QByteArray id;
+            const int len = 1 + below( 12 );
+            for( int j = 0; j < len; j++ )
+            {
+                if( j > 0 && below( 4 ) == 0 )
+                    id += char( '0' + below( 10 ) );
+                else
+                    id += s_letters[ below( 52 ) ];
+            }
+            // no keywords, which are case insensitive unless quoted
+            const QList<Alg::Token> toks = Alg::Lexer().tokens( id );
+            if( toks.size() == 1 && toks.first().d_type == Alg::Tok_identifier && toks.first().d_code == Alg::Tok_identifier )
+                d_names.append( id );
+        }
+    }
+    QByteArray generate( int size )
+    {
+        d_out.clear();
+        d_out.reserve( size + 1024 );
+        d_col = 0;
+        d_cmtBytes = 0;
+        keyword( "begin" );
+        while( d_out.size() < size )
+            statement( 0 );
+        keyword( "end" );
+        newline();
+        return d_out;
+    }
+private:
+    quint32 next()
+    {
+        // xorshift32, the same sequence on all platforms
+        d_state ^= d_state << 13;
+        d_state ^= d_state >> 17;
+        d_state ^= d_state << 5;
+        return d_state;
+    }
+    int below( int n ) { return next() % n; }
+    bool chance( double p ) { return ( next() & 0xffffff ) < p * 0x1000000; }
+
+    void newline()
+    {
+        d_out += '\n';
+        d_col = 0;
+    }
+    void word( const QByteArray& str )
+    {
+        if( d_col > 0 && d_col + str.size() >= d_spec.d_lineLen )
+            newline();
+        else if( d_col > 0 )
+        {
+            d_out += ' ';
+            d_col++;
+        }
+        d_out += str;
+        d_col += str.size();
+        if( d_inComment )
+            d_cmtBytes += str.size() + 1;
+    }
+    void keyword( const char* kw )
+    {
+        if( d_spec.d_quoted )
+            word( "'" + QByteArray( kw ).toUpper() + "'" );
+        else
+            word( kw );
+    }
+    void op( const char* ascii, const char* pub )
+    {
+        word( chance( d_spec.d_pub ) ? pub : ascii );
+    }
+    void ident() { word( d_names[ below( d_names.size() ) ] ); }
+    void number()
+    {
+        QByteArray num = QByteArray::number( below( 100000 ) );
+        if( below( 3 ) == 0 )
+        {
+            num += '.';
+            num += QByteArray::number( below( 1000 ) );
+            if( below( 2 ) == 0 )
+                num += ( chance( d_spec.d_pub ) ? "⏨" : "e" ) + QByteArray::number( below( 40 ) - 20 );
+        }
+        word( num );
+    }
+    void operand()
+    {
+        if( chance( d_spec.d_idents ) )
+            ident();
+        else
+            number();
+    }
+    void expression( int depth = 0 )
+    {
+        const int terms = 1 + below( 4 );
+        for( int i = 0; i < terms; i++ )
+        {
+            if( i > 0 )
+            {
+                switch( below( 5 ) )
+                {
+                case 0:
+                    word( "+" );
+                    break;
+                case 1:
+                    word( "-" );
+                    break;
+                case 2:
+                    op( "*", "×" );
+                    break;
+                case 3:
+                    op( "/", "÷" );
+                    break;
+                default:
+                    op( "**", "↑" );
+                    break;
+                }
+            }
+            if( depth < 2 && below( 6 ) == 0 )
+            {
+                word( "(" );
+                expression( depth + 1 );
+                word( ")" );
+            }else
+                operand();
+        }
+    }
+    void condition()
+    {
+        const int terms = 1 + below( 2 );
+        for( int i = 0; i < terms; i++ )
+        {
+            if( i > 0 )
+            {
+                if( below( 2 ) == 0 )
+                    op( "&", "∧" );
+                else
+                    op( "|", "∨" );
+            }
+            if( below( 8 ) == 0 )
+                op( "!", "¬" );
+            expression();
+            switch( below( 5 ) )
+            {
+            case 0:
+                word( "<" );
+                break;
+            case 1:
+                op( "<=", "≤" );
+                break;
+            case 2:
+                op( ">=", "≥" );
+                break;
+            case 3:
+                op( "!=", "≠" );
+                break;
+            default:
+                word( "=" );
+                break;
+            }
+            expression();
+        }
+    }
+    void assignment()
+    {
+        ident();
+        word( ":=" );
+        expression();
+    }
+    void comment()
+    {
+        static const char* s_words[] = { "the", "value", "of", "each", "element", "is", "computed", "by",
+                                         "procedure", "which", "returns", "result", "in", "array", "step", "x" };
+        keyword( "comment" );
+        d_inComment = true;
+        const int words = 5 + below( 60 );
+        for( int i = 0; i < words; i++ )
+            word( s_words[ below( 16 ) ] );
+        d_inComment = false;
+        word( ";" );
+    }
+    void statement( int depth )
+    {
+        while( d_cmtBytes < d_spec.d_comments * d_out.size() )
+            comment();
+        switch( below( 10 ) )
+        {
+        case 5:
+            keyword( "if" );
+            condition();
+            keyword( "then" );
+            assignment();
+            keyword( "else" );
+            assignment();
+            break;
+        case 6:
+            keyword( "for" );
+            ident();
+            word( ":=" );
+            word( "1" );
+            keyword( "step" );
+            word( "1" );
+            keyword( "until" );
+            expression();
+            keyword( "do" );
+            assignment();
+            break;
+        case 7:
+            if( depth < 3 )
+            {
+                keyword( "begin" );
+                const int n = 2 + below( 5 );
+                for( int i = 0; i < n; i++ )
+                    statement( depth + 1 );
+                keyword( "end" );
+            }else
+                assignment();
+            break;
+        case 8:
+            keyword( below( 2 ) == 0 ? "integer" : "real" );
+            if( below( 3 ) == 0 )
+            {
+                keyword( "array" );
+                ident();
+                word( "[" );
+                word( "1" );
+                word( ":" );
+                operand();
+                word( "]" );
+            }else
+            {
+                ident();
+                word( "," );
+                ident();
+            }
+            break;
+        case 9:
+            ident();
+            word( "(" );
+            expression();
+            word( "," );
+            expression();
+            word( ")" );
+            break;
+        default:
+            assignment();
+            break;
+        }
+        word( ";" );
+    }
+
+    CorpusSpec d_spec;
+    QList<QByteArray> d_names;
+    QByteArray d_out;
+    quint32 d_state;
+    int d_col;
+    int d_cmtBytes;
+    bool d_inComment;
+};
+
+enum Mode { NextToken, PeekToken, Tokens, Parallel, MaxMode };
+static const char* s_modeNames[] = { "next", "peek", "tokens", "parallel" };
+
+struct Result
+{
+    qint64 d_tokens;
+    qint64 d_nsecs;
+    int d_allocs;
+    Result():d_tokens(0),d_nsecs(0),d_allocs(0){}
+};
+
+static Result run( Mode mode, const QByteArray& code )
+{
+    Result res;
+    QElapsedTimer timer;
+    const int allocs = allocCount();
+    timer.start();
+    Alg::Lexer lex;
+    switch( mode )
+    {
+    case NextToken:
+        lex.setBuffer( code, "bench" );
+        for( Alg::Token t = lex.nextToken(); !t.isEof(); t = lex.nextToken() )
+            res.d_tokens++;
+        break;
+    case PeekToken:
+        // like the parser, which looks up to two tokens ahead before it consumes one
+        lex.setBuffer( code, "bench" );
+        while( !lex.peekToken(1).isEof() )
+        {
+            lex.peekToken(2);
+            lex.nextToken();
+            res.d_tokens++;
+        }
+        break;
+    case Tokens:
+        res.d_tokens = lex.tokens( code, "bench" ).size();
+        break;
+    case Parallel:
+        res.d_tokens = lex.tokensParallel( code, "bench" ).size();
+        break;
+    default:
+        break;
+    }
+    res.d_nsecs = timer.nsecsElapsed();
+    res.d_allocs = allocCount() - allocs;
+    return res;
+}
+
+static QList<CorpusSpec> predefinedCorpora()
+{
+    QList<CorpusSpec> res;
+    res << CorpusSpec( "base" );
+    res << CorpusSpec( "idents", 0.95 );
+    res << CorpusSpec( "numbers", 0.05 );
+    res << CorpusSpec( "comments", 0.5, 0.5 );
+    res << CorpusSpec( "pub", 0.5, 0.05, 1.0 );
+    res << CorpusSpec( "quoted", 0.5, 0.05, 0.0, true );
+    res << CorpusSpec( "longlines", 0.5, 0.05, 0.0, false, 4000 );
+    return res;
+}
+
+class SymbolLookup : public QRunnable
+{
+    // looks up all names several times, starting at a different name in each thread
+public:
+    SymbolLookup( const QList<QByteArray>& names, const QVector<Alg::Symbols::Atom>& atoms, int start ):
+        d_names(names),d_atoms(atoms),d_start(start),d_errors(0) { setAutoDelete(false); }
+    void run()
+    {
+        const int n = d_names.size();
+        for( int r = 0; r < SymbolRounds; r++ )
+        {
+            for( int i = 0; i < n; i++ )
+            {
+                const int j = ( d_start + i ) % n;
+                const QByteArray& name = d_names[j];
+                if( Alg::Symbols::atom( name.constData(), name.size() ) != d_atoms[j] )
+                    d_errors++;
+            }
+        }
+    }
+    enum { SymbolRounds = 5 };
+    const QList<QByteArray>& d_names;
+    const QVector<Alg::Symbols::Atom>& d_atoms;
+    int d_start;
+    int d_errors;
+};
+
+static int symbolScaling( QTextStream& out, int maxThreads )
+{
+    // distinct names, interned once up front, so that the threads measure the wait-free lookup
+    QList<QByteArray> names;
+    QVector<Alg::Symbols::Atom> atoms;
+    const int count = 200000;
+    QElapsedTimer timer;
+    timer.start();
+    for( int i = 0; i < count; i++ )
+    {
+        names << "sym" + QByteArray::number( i, 36 );
+        atoms << Alg::Symbols::atom( names.last().constData(), names.last().size() );
+        if( Alg::Symbols::symbol( atoms.last() ) != names.last() )
+        {
+            qCritical() << "error: atom" << atoms.last() << "does not resolve to" << names.last() << endl;
+            return -1;
+        }
+    }
+    out << QString("intern        %1 M symbols/s").arg( count / ( qMax( timer.nsecsElapsed(), qint64(1) ) / 1e9 ) / 1e6,
+                                                       0, 'f', 2 ) << endl;
+    out << "threads  Mlookups/s" << endl;
+    QThreadPool pool;
+    pool.setMaxThreadCount( maxThreads );
+    QList<int> steps;
+    for( int threads = 1; threads < maxThreads; threads *= 2 )
+        steps << threads;
+    steps << maxThreads;
+    foreach( const int threads, steps )
+    {
+        QList<SymbolLookup*> jobs;
+        for( int t = 0; t < threads; t++ )
+            jobs << new SymbolLookup( names, atoms, t * count / threads );
+        timer.start();
+        foreach( SymbolLookup* job, jobs )
+            pool.start( job );
+        pool.waitForDone();
+        const double secs = qMax( timer.nsecsElapsed(), qint64(1) ) / 1e9;
+        int errors = 0;
+        foreach( SymbolLookup* job, jobs )
+            errors += job->d_errors;
+        qDeleteAll( jobs );
+        out << QString("%1 %2").arg( threads, 7 )
+               .arg( double(threads) * count * SymbolLookup::SymbolRounds / secs / 1e6, 11, 'f', 2 ) << endl;
+        if( errors )
+        {
+            qCritical() << "error:" << errors << "lookups returned a wrong atom" << endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setOrganizationName("me@rochus-keller.ch");
+    a.setOrganizationDomain("https://github.com/rochus-keller/Algol");
+    a.setApplicationName("AlgLexBench");
+    a.setApplicationVersion("2020-08-01");
+
+    QTextStream out(stdout);
+
+    QList<CorpusSpec> specs = predefinedCorpora();
+    CorpusSpec custom;
+    bool useCustom = false;
+    QStringList corpora, files;
+    QString csvPath, dumpPath;
+    QList<Mode> modes;
+    int size = 4, reps = 5, symbolThreads = 0;
+    quint32 seed = 1;
+    const QStringList args = QCoreApplication::arguments();
+    for( int i = 1; i < args.size(); i++ ) // arg 0 enthaelt Anwendungspfad
+    {
+        if( args[i] == "-h" )
+        {
+            out << "usage: AlgLexBench [options] [files]" << endl;
+            out << "  measures the lexer on generated sources and on the given files" << endl;
+            out << "options:" << endl;
+            out << "  -size=MB      size of each generated source (default 4)" << endl;
+            out << "  -reps=n       runs per measurement, the fastest counts (default 5)" << endl;
+            out << "  -seed=n       seed of the generator (default 1)" << endl;
+            out << "  -corpus=a,b   predefined sources to generate (default all):" << endl;
+            out << "               ";
+            foreach( const CorpusSpec& s, specs )
+                out << " " << s.d_name;
+            out << endl;
+            out << "  -ids=x        generate a custom source instead, with share x of identifier operands," << endl;
+            out << "  -cmt=x        share x of bytes in comments," << endl;
+            out << "  -pub=x        share x of publication symbols for operators," << endl;
+            out << "  -quoted       quoted keywords," << endl;
+            out << "  -line=n       and line length n" << endl;
+            out << "  -modes=a,b    next, peek, tokens and/or parallel (default all)" << endl;
+            out << "  -csv=path     write the results to a csv file" << endl;
+            out << "  -dump=path    save the generated sources in this directory" << endl;
+            out << "  -symbols=n    measure the symbol lookup with 1, 2, 4 .. n threads instead" << endl;
+            out << "  -h            display this information" << endl;
+            return 0;
+        }else if( args[i].startsWith("-size=") )
+            size = qMax( 1, args[i].mid(6).toInt() );
+        else if( args[i].startsWith("-reps=") )
+            reps = qMax( 1, args[i].mid(6).toInt() );
+        else if( args[i].startsWith("-seed=") )
+            seed = args[i].mid(6).toUInt();
+        else if( args[i].startsWith("-corpus=") )
+            corpora = args[i].mid(8).split(',');
+        else if( args[i].startsWith("-ids=") )
+        {
+            custom.d_idents = args[i].mid(5).toDouble();
+            useCustom = true;
+        }else if( args[i].startsWith("-cmt=") )
+        {
+            custom.d_comments = qBound( 0.0, args[i].mid(5).toDouble(), 0.9 );
+            useCustom = true;
+        }else if( args[i].startsWith("-pub=") )
+        {
+            custom.d_pub = args[i].mid(5).toDouble();
+            useCustom = true;
+        }else if( args[i] == "-quoted" )
+        {
+            custom.d_quoted = true;
+            useCustom = true;
+        }else if( args[i].startsWith("-line=") )
+        {
+            custom.d_lineLen = qMax( 1, args[i].mid(6).toInt() );
+            useCustom = true;
+        }else if( args[i].startsWith("-modes=") )
+        {
+            foreach( const QString& m, args[i].mid(7).split(',') )
+            {
+                int j = 0;
+                while( j < MaxMode && m != s_modeNames[j] )
+                    j++;
+                if( j == MaxMode )
+                {
+                    qCritical() << "error: invalid mode" << m << endl;
+                    return -1;
+                }
+                modes << Mode(j);
+            }
+        }else if( args[i].startsWith("-csv=") )
+            csvPath = args[i].mid(5);
+        else if( args[i].startsWith("-dump=") )
+            dumpPath = args[i].mid(6);
+        else if( args[i].startsWith("-symbols=") )
+            symbolThreads = qMax( 1, args[i].mid(9).toInt() );
+        else if( !args[ i ].startsWith( '-' ) )
+            files += args[ i ];
+        else
+        {
+            qCritical() << "error: invalid command line option " << args[i] << endl;
+            return -1;
+        }
+    }
+    if( symbolThreads )
+        return symbolScaling( out, symbolThreads );
+    if( modes.isEmpty() )
+    {
+        for( int j = 0; j < MaxMode; j++ )
+            modes << Mode(j);
+    }
+    if( useCustom )
+        specs = QList<CorpusSpec>() << custom;
+    else if( !corpora.isEmpty() )
+    {
+        QList<CorpusSpec> selected;
+        foreach( const QString& name, corpora )
+        {
+            int j = 0;
+            while( j < specs.size() && specs[j].d_name != name.toUtf8() )
+                j++;
+            if( j == specs.size() )
+            {
+                qCritical() << "error: unknown corpus" << name << endl;
+                return -1;
+            }
+            selected << specs[j];
+        }
+        specs = selected;
+    }else if( !files.isEmpty() )
+        specs.clear();
+
+    QList< QPair<QByteArray,QByteArray> > sources; // name, code
+    foreach( const CorpusSpec& s, specs )
+    {
+        Generator gen( s, seed );
+        sources << qMakePair( s.d_name, gen.generate( size * 1024 * 1024 ) );
+        if( !dumpPath.isEmpty() )
+        {
+            QFile f( QDir(dumpPath).absoluteFilePath( s.d_name + ".alg" ) );
+            if( f.open( QIODevice::WriteOnly ) )
+                f.write( sources.last().second );
+            else
+                qWarning() << "cannot write" << f.fileName();
+        }
+    }
+    foreach( const QString& path, files )
+    {
+        QFile f( path );
+        if( !f.open( QIODevice::ReadOnly ) )
+        {
+            qCritical() << "error: cannot open file" << path << endl;
+            return -1;
+        }
+        sources << qMakePair( QFileInfo(path).fileName().toUtf8(), f.readAll() );
+    }
+
+    QFile csv;
+    QTextStream csvOut;
+    if( !csvPath.isEmpty() )
+    {
+        csv.setFileName( csvPath );
+        if( !csv.open( QIODevice::WriteOnly ) )
+        {
+            qCritical() << "error: cannot write" << csvPath << endl;
+            return -1;
+        }
+        csvOut.setDevice( &csv );
+        csvOut << "date,corpus,mode,bytes,lines,tokens,reps,seconds,mb_per_s,mtok_per_s,allocs_per_token" << endl;
+    }
+    const QString date = QDateTime::currentDateTime().toString( Qt::ISODate );
+
+    out << "corpus        mode          MB/s    Mtok/s  allocs/tok" << endl;
+    for( int i = 0; i < sources.size(); i++ )
+    {
+        const QByteArray& code = sources[i].second;
+        const int lines = code.count('\n');
+        foreach( Mode m, modes )
+        {
+            Result best;
+            for( int r = 0; r < reps; r++ )
+            {
+                const Result res = run( m, code );
+                if( r == 0 || res.d_nsecs < best.d_nsecs )
+                    best = res;
+            }
+            const double secs = qMax( best.d_nsecs, qint64(1) ) / 1e9;
+            const double mbs = code.size() / secs / 1e6;
+            const double mtoks = best.d_tokens / secs / 1e6;
+            const double allocs = best.d_tokens ? double( best.d_allocs ) / best.d_tokens : 0.0;
+            out << QString("%1 %2 %3 %4 %5").arg( QString::fromUtf8(sources[i].first), -13 )
+                   .arg( s_modeNames[m], -9 ).arg( mbs, 8, 'f', 1 ).arg( mtoks, 9, 'f', 2 )
+                   .arg( s_countAllocs ? QString::number( allocs, 'f', 3 ) : QString("n/a"), 11 ) << endl;
+            if( csv.isOpen() )
+                csvOut << date << "," << sources[i].first << "," << s_modeNames[m] << "," << code.size() << ","
+                       << lines << "," << best.d_tokens << "," << reps << "," << QString::number( secs, 'f', 6 )
+                       << "," << QString::number( mbs, 'f', 2 ) << "," << QString::number( mtoks, 'f', 3 )
+                       << "," << ( s_countAllocs ? QString::number( allocs, 'f', 4 ) : QString() ) << endl;
+        }
+    }
+    return 0;
+}
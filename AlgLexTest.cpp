@@ -0,0 +1,157 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include "AlgLexer.h"
+
+// Regression cases for the lexer; prints the failed cases and exits with their number.
+
+static int s_failed = 0;
+
+static void check( bool ok, const char* what )
+{
+    if( !ok )
+    {
+        QTextStream out(stdout);
+        out << "FAILED: " << what << endl;
+        s_failed++;
+    }
+}
+
+static QList<Alg::Token> lex( const QByteArray& code )
+{
+    Alg::Lexer lex;
+    return lex.tokens( code );
+}
+
+static QByteArray types( const QList<Alg::Token>& toks )
+{
+    QByteArray res;
+    foreach( const Alg::Token& t, toks )
+    {
+        if( t.d_type == Alg::Tok_Comment )
+            continue;
+        if( !res.isEmpty() )
+            res += ' ';
+        res += Alg::tokenTypeName( t.d_type );
+    }
+    return res;
+}
+
+static void testDialect()
+{
+    // a quoted keyword in a comment or string must not select the quoted keyword dialect
+    const QByteArray inComment = "begin comment the Algol 60 report writes 'begin' and 'end'; x := 1 end";
+    check( Alg::Lexer::detectDialect( inComment.constData(), inComment.size() ) == Alg::Lexer::LowerCase,
+           "quoted keyword in comment" );
+    check( types( lex( inComment ) ) == "Tok_BEGIN Tok_identifier Tok_ColonEq Tok_unsigned_integer Tok_END",
+           "lower case program with quoted keyword in comment" );
+
+    const QByteArray inEndComment = "begin x := 1 end of 'begin' block";
+    check( Alg::Lexer::detectDialect( inEndComment.constData(), inEndComment.size() ) == Alg::Lexer::LowerCase,
+           "quoted keyword after end" );
+
+    const QByteArray inString = "begin outstring(1, \"write 'end' here\"); outstring(1, \xe2\x80\x98'if'\xe2\x80\x99) end";
+    check( Alg::Lexer::detectDialect( inString.constData(), inString.size() ) == Alg::Lexer::LowerCase,
+           "quoted keyword in string" );
+
+    const QByteArray quoted = "'BEGIN' 'COMMENT' begin and end; X := 1 'END'";
+    check( Alg::Lexer::detectDialect( quoted.constData(), quoted.size() ) == Alg::Lexer::QuotedKeywords,
+           "quoted keyword dialect" );
+
+    const QByteArray upper = "COMMENT 'begin'; BEGIN X := 1 END";
+    check( Alg::Lexer::detectDialect( upper.constData(), upper.size() ) == Alg::Lexer::UpperCase,
+           "upper case program with quoted keyword in comment" );
+}
+
+static void testUnderlines()
+{
+    // U+0332 after any character is skipped, also inside and after operators
+    const QByteArray u = "\xcc\xb2";
+    check( types( lex( "x :" + u + "= 1" ) ) == "Tok_identifier Tok_ColonEq Tok_unsigned_integer",
+           "underlined assignment" );
+    check( types( lex( "x :" + u + "=" + u + " 1" ) ) == "Tok_identifier Tok_ColonEq Tok_unsigned_integer",
+           "underlined assignment, both characters" );
+    check( types( lex( "a \xe2\x89\xa4" + u + " b" ) ) == "Tok_identifier Tok_Uleq Tok_identifier",
+           "underlined unicode operator" );
+    check( types( lex( "a <" + u + "=" + u + "b" ) ) == "Tok_identifier Tok_Leq Tok_identifier",
+           "underlined operator before identifier" );
+    check( types( lex( "f(" + u + "x," + u + "y)" + u + ";" + u ) ) ==
+           "Tok_identifier Tok_Lpar Tok_identifier Tok_Comma Tok_identifier Tok_Rpar Tok_Semi",
+           "underlined punctuation" );
+    const QList<Alg::Token> toks = lex( "x :" + u + "=" + u + " 1" );
+    check( toks.size() == 3 && toks[1].d_colNr == 3 && toks[1].d_len == 2 && toks[1].d_byteLen == 4,
+           "position and length of underlined operator" );
+}
+
+static Alg::Lexer::NumberStatus decode( const QByteArray& num )
+{
+    Alg::Token t( Alg::Tok_decimal_number, 1, 1, num.size(), num );
+    return Alg::Lexer::decodeNumber( t );
+}
+
+static void testNumbers()
+{
+    check( decode( "0.1" ) == Alg::Lexer::NumberOk, "0.1" );
+    check( decode( "1.000000000000000000000" ) == Alg::Lexer::NumberOk, "trailing zeros are not significant" );
+    check( decode( "0.000000000000000000123" ) == Alg::Lexer::NumberOk, "leading zeros are not significant" );
+    check( decode( "3.14159265358979323846" ) == Alg::Lexer::NumberInexact, "too many significant digits" );
+    check( decode( "1234567890123456.0" ) == Alg::Lexer::NumberOk, "16 digits stored exactly" );
+    check( decode( "0.1234567890123456" ) == Alg::Lexer::NumberOk, "16 digit fraction is preserved" );
+    check( decode( "12345678901234568.0" ) == Alg::Lexer::NumberOk, "17 digits stored exactly" );
+    check( decode( "0.50000000000000011" ) == Alg::Lexer::NumberOk, "17 digit fraction is preserved" );
+    check( decode( "12345678901234567.0" ) == Alg::Lexer::NumberInexact, "17 digits rounded" );
+    check( decode( "1.0e400" ) == Alg::Lexer::NumberOverflow, "overflow" );
+    check( decode( "1.0e-400" ) == Alg::Lexer::NumberUnderflow, "underflow" );
+}
+
+static void testUtf16Offsets()
+{
+    // tokens of a source passed as QChars have QChar offsets
+    const QString code = QString::fromUtf8( "\xc3\xa4x :\xcc\xb2= 1; \xf0\x9d\x90\x80 := y" );
+    Alg::Lexer lex;
+    const QList<Alg::Token> toks = lex.tokens( code );
+    check( toks.size() == 7, "number of tokens from QChars" );
+    if( toks.size() != 7 )
+        return;
+    check( toks[0].d_offset == 0 && toks[0].d_byteLen == 2, "offset of non-ascii identifier" );
+    check( toks[1].d_offset == 3 && toks[1].d_byteLen == 3, "offset of underlined operator" );
+    check( toks[2].d_offset == 7 && toks[2].d_byteLen == 1, "offset after underline" );
+    check( toks[4].d_offset == 10 && toks[4].d_byteLen == 2, "offset of surrogate pair" );
+    check( toks[6].d_offset == 16 && toks[6].d_byteLen == 1, "offset after surrogate pair" );
+    for( int i = 0; i < toks.size(); i++ )
+        check( code.mid( toks[i].d_offset, toks[i].d_byteLen ).remove( QChar(0x332) ) == QString::fromUtf8( toks[i].d_val ),
+               "QChar span is the token" );
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    testDialect();
+    testUnderlines();
+    testNumbers();
+    testUtf16Offsets();
+
+    QTextStream out(stdout);
+    if( s_failed == 0 )
+        out << "all lexer tests passed" << endl;
+    return s_failed;
+}
@@ -20,18 +20,30 @@
 #include "AlgLexer.h"
 #include "AlgErrors.h"
 #include "AlgFileCache.h"
+#include "AlgSourceRegistry.h"
+#include "AlgLineIndex.h"
+#include "AlgSymbols.h"
 #include <QBuffer>
 #include <QFile>
 #include <QIODevice>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QVarLengthArray>
+#include <QtNumeric>
 #include <ctype.h>
+#include <string.h>
+#include <limits>
+#include <algorithm>
 #include <QtDebug>
 using namespace Alg;
 
-QHash<QByteArray,QByteArray> Lexer::d_symbols;
-
 Lexer::Lexer(QObject *parent) : QObject(parent),
-    d_lastToken(Tok_Invalid),d_lineNr(0),d_colNr(0),d_in(0),d_err(0),d_fcache(0),
-    d_ignoreComments(true), d_packComments(true),d_quotedKeywords(false)
+    d_in(0),d_err(0),d_fcache(0),d_registry(0),d_fileId(0),d_base(0),
+    d_end(0),d_next(0),d_lineStart(0),d_lineEnd(0),d_cur(0),d_colPos(0),d_lineOffset(0),d_lineNr(0),d_colNr(0),
+    d_utf16Byte(0),d_utf16Off(0),d_states(0),d_lastToken(Tok_Invalid),d_scan(&Lexer::nextTokenImp<false>),
+    d_quotedKeywords(false),d_dialect(LowerCase),d_mode(LexerState::Normal),d_streaming(false),
+    d_ignoreComments(true), d_packComments(true),d_chunk(0),d_utf16(false)
 {
 
 }
@@ -42,91 +54,225 @@ void Lexer::setStream(QIODevice* in, const QString& sourcePath)
         setStream( sourcePath );
     else
     {
-        if( d_in != 0 && d_in->parent() == this )
-            d_in->deleteLater();
+        QByteArray content;
+        QBuffer* buf = qobject_cast<QBuffer*>(in);
+        QFile* file = qobject_cast<QFile*>(in);
+        if( buf )
+            content = buf->pos() == 0 ? buf->data() : buf->data().mid(buf->pos());
+        else if( file && in->parent() == this && d_registry == 0 && !file->isSequential() && file->size() > file->pos() )
+        {
+            // we own the file, so the mapping stays valid as long as we need it; not so if the
+            // buffer is handed to the registry
+            const qint64 len = file->size() - file->pos();
+            const uchar* data = file->map( file->pos(), len );
+            if( data )
+                content = QByteArray::fromRawData( (const char*)data, len );
+        }
+        if( d_in != in )
+            releaseStream();
         d_in = in;
-        d_lineNr = 0;
-        d_colNr = 0;
-        d_sourcePath = sourcePath;
-        d_lastToken = Tok_Invalid;
+        if( content.isNull() && d_registry == 0 )
+        {
+            // the registry needs the whole source, otherwise we don't
+            static const int window = 64 * 1024;
+            setSource( QByteArray( window, 0 ), sourcePath );
+            d_end = d_next = d_buf.constData();
+            d_streaming = true;
+            fill();
+            setDialect( detectDialect( d_buf.constData(), d_end - d_buf.constData() ) );
+            return;
+        }
+        if( content.isNull() )
+            content = in->readAll();
+        setBuffer( content, sourcePath );
     }
 }
 
 bool Lexer::setStream(const QString& sourcePath)
 {
-    QIODevice* in = 0;
-
     if( d_fcache )
     {
         bool found;
         QByteArray content = d_fcache->getFile(sourcePath, &found );
         if( found )
         {
-            QBuffer* buf = new QBuffer(this);
-            buf->setData( content );
-            buf->open(QIODevice::ReadOnly);
-            in = buf;
+            releaseStream();
+            setBuffer( content, sourcePath );
+            return true;
         }
     }
 
-    if( in == 0 )
+    QFile* file = new QFile(sourcePath, this);
+    if( !file->open(QIODevice::ReadOnly) )
     {
-        QFile* file = new QFile(sourcePath, this);
-        if( !file->open(QIODevice::ReadOnly) )
+        if( d_err )
         {
-            if( d_err )
-            {
-                d_err->error(Errors::Lexer, sourcePath, 0, 0,
-                                 tr("cannot open file from path %1").arg(sourcePath) );
-            }
-            delete file;
-            return false;
+            d_err->error(Errors::Lexer, sourcePath, 0, 0,
+                             tr("cannot open file from path %1").arg(sourcePath) );
         }
-        in = file;
+        delete file;
+        return false;
     }
     // else
-    setStream( in, sourcePath );
+    setStream( file, sourcePath );
     return true;
 }
 
+void Lexer::setBuffer(const QByteArray& utf8, const QString& sourcePath)
+{
+    setSource( utf8, sourcePath );
+    setDialect( detectDialect( d_buf.constData(), d_buf.size() ) );
+}
+
+void Lexer::setBuffer(const QChar* str, int len, const QString& sourcePath)
+{
+    // the scanner works on utf-8 only, so the string is transcoded and the offsets of the delivered
+    // tokens are mapped back to QChars, see toUtf16; the capacity of d_encoded is reused if it is no
+    // longer shared with d_buf, i.e. as long as there is no registry keeping the previous source
+    d_buf.clear();
+    d_encoded.resize( len * 3 );
+    char* out = d_encoded.data();
+    for( int i = 0; i < len; i++ )
+    {
+        uint ch = str[i].unicode();
+        if( ch < 0x80 )
+        {
+            *out++ = ch;
+            continue;
+        }
+        if( QChar::isHighSurrogate(ch) && i + 1 < len && QChar::isLowSurrogate( str[i+1].unicode() ) )
+            ch = QChar::surrogateToUcs4( ch, str[++i].unicode() );
+        else if( QChar::isSurrogate(ch) )
+            ch = QChar::ReplacementCharacter;
+        if( ch < 0x800 )
+        {
+            *out++ = 0xc0 | ( ch >> 6 );
+        }else if( ch < 0x10000 )
+        {
+            *out++ = 0xe0 | ( ch >> 12 );
+            *out++ = 0x80 | ( ( ch >> 6 ) & 0x3f );
+        }else
+        {
+            *out++ = 0xf0 | ( ch >> 18 );
+            *out++ = 0x80 | ( ( ch >> 12 ) & 0x3f );
+            *out++ = 0x80 | ( ( ch >> 6 ) & 0x3f );
+        }
+        *out++ = 0x80 | ( ch & 0x3f );
+    }
+    d_encoded.resize( out - d_encoded.constData() );
+    setBuffer( d_encoded, sourcePath );
+    d_utf16 = true;
+}
+
+void Lexer::setDialect(Lexer::Dialect d)
+{
+    d_dialect = d;
+    d_quotedKeywords = d == QuotedKeywords || d == UnderlinedKeywords;
+    d_scan = d_quotedKeywords ? &Lexer::nextTokenImp<true> : &Lexer::nextTokenImp<false>;
+}
+
+void Lexer::setSource(const QByteArray& utf8, const QString& sourcePath)
+{
+    d_buf = utf8;
+    d_base = 0;
+    d_streaming = false;
+    d_cur = d_buf.constData();
+    d_end = d_cur + d_buf.size();
+    d_next = d_lineStart = d_lineEnd = d_colPos = d_cur;
+    d_lineOffset = 0;
+    d_lineNr = 0;
+    d_colNr = 0;
+    d_sourcePath = sourcePath;
+    d_lastToken = Tok_Invalid;
+    d_mode = LexerState::Normal;
+    d_utf16 = false;
+    d_utf16Byte = d_utf16Off = 0;
+    d_fileId = d_registry ? d_registry->addSource( sourcePath, d_buf ) : 0;
+}
+
+void Lexer::releaseStream()
+{
+    d_buf.clear(); // before the file is deleted, because d_buf could point to the mapped file
+    d_base = 0;
+    d_streaming = false;
+    d_end = d_next = d_lineStart = d_lineEnd = d_cur = d_colPos = 0;
+    if( d_in != 0 && d_in->parent() == this )
+        d_in->deleteLater();
+    d_in = 0;
+}
+
 Token Lexer::nextToken()
 {
-    Token t;
     if( !d_buffer.isEmpty() )
-    {
-        t = d_buffer.first();
-        d_buffer.pop_front();
-    }else
-        t = nextTokenImp();
-    if( t.d_type == Tok_Comment && d_ignoreComments )
-        t = nextToken();
+        return d_buffer.take_front();
+    Token t = (this->*d_scan)();
+    while( t.d_type == Tok_Comment && d_ignoreComments )
+        t = (this->*d_scan)();
+    if( d_utf16 )
+        toUtf16( t );
     return t;
 }
 
-Token Lexer::peekToken(quint8 lookAhead)
+const Token& Lexer::peekToken(quint8 lookAhead)
 {
     Q_ASSERT( lookAhead > 0 );
     while( d_buffer.size() < lookAhead )
     {
-        Token t = nextTokenImp();
+        Token t = (this->*d_scan)();
         while( t.d_type == Tok_Comment && d_ignoreComments )
-            t = nextTokenImp();
-        d_buffer.push_back( t );
+            t = (this->*d_scan)();
+        if( d_utf16 )
+            toUtf16( t );
+        d_buffer.push_back( std::move(t) );
     }
     return d_buffer[ lookAhead - 1 ];
 }
 
+static inline quint32 utf16Units( const char* str, const char* end )
+{
+    // unlike LineIndex::utf16Len the underlines are counted, since they are QChars of the source
+    quint32 n = 0;
+    for( const uchar* s = (const uchar*)str; s < (const uchar*)end; s++ )
+    {
+        if( ( *s & 0xc0 ) != 0x80 )
+            n++;
+        if( *s >= 0xf0 )
+            n++; // surrogate pair
+    }
+    return n;
+}
+
+void Lexer::toUtf16(Token& t)
+{
+    // the tokens come in source order, so the offset is counted on from the one of the previous token
+    const char* buf = d_buf.constData();
+    if( t.d_offset < d_utf16Byte )
+        d_utf16Byte = d_utf16Off = 0;
+    d_utf16Off += utf16Units( buf + d_utf16Byte, buf + t.d_offset );
+    d_utf16Byte = t.d_offset;
+    t.d_byteLen = utf16Units( buf + t.d_offset, buf + t.d_offset + t.d_byteLen );
+    t.d_offset = d_utf16Off;
+}
+
 QList<Token> Lexer::tokens(const QString& code)
 {
-    return tokens( code.toLatin1() );
+    releaseStream();
+    setBuffer( code.constData(), code.size() );
+
+    QList<Token> res;
+    Token t = nextToken();
+    while( t.isValid() )
+    {
+        res << t;
+        t = nextToken();
+    }
+    return res;
 }
 
 QList<Token> Lexer::tokens(const QByteArray& code, const QString& path)
 {
-    QBuffer in;
-    in.setData( code );
-    in.open(QIODevice::ReadOnly);
-    setStream( &in, path );
+    releaseStream();
+    setBuffer( code, path );
 
     QList<Token> res;
     Token t = nextToken();
@@ -138,120 +284,655 @@ QList<Token> Lexer::tokens(const QByteArray& code, const QString& path)
     return res;
 }
 
+LexerState Lexer::state() const
+{
+    return LexerState( d_base + ( d_next - d_buf.constData() ), d_lineNr + 1, d_mode, d_quotedKeywords );
+}
+
+void Lexer::restart(const LexerState& s)
+{
+    Q_ASSERT( !d_streaming && s.d_offset <= quint32(d_buf.size()) );
+    d_buffer.clear();
+    d_next = d_buf.constData() + s.d_offset;
+    d_lineStart = d_lineEnd = d_cur = d_colPos = d_next; // nextTokenImp continues with nextLine
+    d_lineOffset = s.d_offset;
+    d_lineNr = s.d_lineNr - 1;
+    d_colNr = 0;
+    d_mode = s.d_mode;
+    if( s.d_quotedKeywords != d_quotedKeywords )
+        setDialect( s.d_quotedKeywords ? QuotedKeywords : LowerCase );
+}
+
+static inline bool stateBefore( const LexerState& lhs, quint32 offset )
+{
+    return lhs.d_offset < offset;
+}
+
+static inline bool tokenBefore( const Token& lhs, quint32 offset )
+{
+    return lhs.d_offset < offset;
+}
+
+int Lexer::relex(const QByteArray& code, quint32 from, quint32 removed, quint32 added,
+                  QList<Token>& tokens, QVector<LexerState>& states, const QString& sourcePath)
+{
+    // restart at the last line start in front of the damage which was reached in the normal state,
+    // i.e. between tokens; if the edit changes the dialect everything is relexed
+    setBuffer( code, sourcePath );
+    int si = std::lower_bound( states.begin(), states.end(), from + 1, stateBefore ) - states.begin() - 1;
+    while( si > 0 && states[si].d_mode != LexerState::Normal )
+        si--;
+    LexerState start;
+    if( si >= 0 && states[si].d_quotedKeywords == d_quotedKeywords )
+        start = states[si];
+    else
+    {
+        si = 0;
+        start.d_quotedKeywords = d_quotedKeywords;
+    }
+    const int ti = std::lower_bound( tokens.begin(), tokens.end(), start.d_offset, tokenBefore ) - tokens.begin();
+
+    const qint64 delta = qint64(added) - qint64(removed);
+    QVector<LexerState>* const log = d_states;
+    QVector<LexerState> newStates;
+    QList<Token> newTokens;
+    d_states = &newStates;
+    restart( start );
+
+    // the text from a line start at or behind from + added is the same as the one at offset - delta in
+    // the previous source; if the lexer reaches such a line in the same state as before, the
+    // remaining tokens are unchanged apart from their position
+    int conv = -1, checked = 0;
+    while( conv == -1 )
+    {
+        const Token t = nextToken();
+        for( ; checked < newStates.size() && conv == -1; checked++ )
+        {
+            const LexerState& s = newStates[checked];
+            if( s.d_offset < from + added || s.d_mode != LexerState::Normal )
+                continue;
+            const quint32 old = s.d_offset - delta;
+            const int k = std::lower_bound( states.begin() + si, states.end(), old, stateBefore ) - states.begin();
+            if( k < states.size() && states[k].d_offset == old &&
+                    states[k].d_mode == s.d_mode && states[k].d_quotedKeywords == s.d_quotedKeywords )
+                conv = k;
+        }
+        if( conv != -1 )
+        {
+            checked--; // the converging state is taken from the log
+            break; // and t from the previous tokens
+        }
+        if( t.d_type == Tok_Eof )
+            break;
+        newTokens.append( t );
+    }
+    d_states = log;
+
+    int tj = tokens.size(), sj = states.size();
+    if( conv != -1 )
+    {
+        tj = std::lower_bound( tokens.begin() + ti, tokens.end(), states[conv].d_offset, tokenBefore ) - tokens.begin();
+        sj = conv;
+        const qint32 lines = qint32( newStates[checked].d_lineNr ) - qint32( states[conv].d_lineNr );
+        for( int i = tj; i < tokens.size(); i++ )
+        {
+            tokens[i].d_offset += delta;
+            tokens[i].d_lineNr += lines;
+        }
+        for( int i = sj; i < states.size(); i++ )
+        {
+            states[i].d_offset += delta;
+            states[i].d_lineNr += lines;
+        }
+    }else
+        checked = newStates.size();
+
+    tokens.erase( tokens.begin() + ti, tokens.begin() + tj );
+    for( int i = 0; i < newTokens.size(); i++ )
+        tokens.insert( ti + i, newTokens[i] );
+    states.erase( states.begin() + si, states.begin() + sj );
+    states.insert( si, checked, LexerState() );
+    for( int i = 0; i < checked; i++ )
+        states[si + i] = newStates[i];
+    return newTokens.size();
+}
+
 QByteArray Lexer::getSymbol(const QByteArray& str)
 {
-    if( str.isEmpty() )
-        return str;
-    QByteArray& sym = d_symbols[str];
-    if( sym.isEmpty() )
-        sym = str;
-    return sym;
+    return Symbols::intern( str );
 }
 
-Token Lexer::nextTokenImp()
+QByteArray Lexer::getSymbol(const char* str, int len)
 {
-    if( d_in == 0 )
-        return token(Tok_Eof);
-    skipWhiteSpace();
+    return Symbols::intern( str, len );
+}
 
-    while( d_colNr >= d_line.size() )
+static inline uint decode( const char* str, const char* end, int* len )
+{
+    // returns the unicode code point at str and its length in bytes; malformed utf-8 yields U+FFFD
+    const uchar* s = (const uchar*)str;
+    const uchar c = s[0];
+    if( c < 0x80 )
+    {
+        *len = 1;
+        return c;
+    }
+    int n;
+    uint cp;
+    if( ( c & 0xe0 ) == 0xc0 )
+    {
+        n = 2;
+        cp = c & 0x1f;
+    }else if( ( c & 0xf0 ) == 0xe0 )
+    {
+        n = 3;
+        cp = c & 0x0f;
+    }else if( ( c & 0xf8 ) == 0xf0 )
     {
-        if( d_in->atEnd() )
+        n = 4;
+        cp = c & 0x07;
+    }else
+    {
+        *len = 1;
+        return 0xfffd;
+    }
+    if( str + n > end )
+    {
+        *len = 1;
+        return 0xfffd;
+    }
+    for( int i = 1; i < n; i++ )
+    {
+        if( ( s[i] & 0xc0 ) != 0x80 )
         {
-            Token t = token( Tok_Eof, 0 );
-            if( d_in->parent() == this )
-                d_in->deleteLater();
-            return t;
+            *len = 1;
+            return 0xfffd;
         }
+        cp = ( cp << 6 ) | ( s[i] & 0x3f );
+    }
+    *len = n;
+    return cp;
+}
+
+// combining low line U+0332, which some sources use to underline keywords; the scanner steps over it
+// where it occurs and it is not part of token values, columns or lengths
+static inline bool isUnderline( const char* str, const char* end )
+{
+    return uchar(str[0]) == 0xcc && str + 1 < end && uchar(str[1]) == 0xb2;
+}
+
+typedef QVarLengthArray<char,64> Stripped;
+
+static inline void removeUnderlines( const char* str, const char* end, Stripped& out )
+{
+    out.reserve( end - str );
+    while( str < end )
+    {
+        if( isUnderline( str, end ) )
+            str += 2;
+        else
+            out.append( *str++ );
+    }
+}
+
+// character classes of the bytes below 0x80; all other bytes start a utf-8 sequence
+// and go through the unicode classification of QChar
+enum CharClass { Letter = 0x01, Digit = 0x02, Space = 0x04, OpStart = 0x08, Quote = 0x10,
+                 NumStart = 0x20, NonAscii = 0x80 };
+
+struct CharClassTable
+{
+    quint8 d_class[256];
+    CharClassTable()
+    {
+        for( int i = 0; i < 256; i++ )
+            d_class[i] = i < 0x80 ? 0 : NonAscii;
+        for( int i = 'a'; i <= 'z'; i++ )
+            d_class[i] |= Letter;
+        for( int i = 'A'; i <= 'Z'; i++ )
+            d_class[i] |= Letter;
+        for( int i = '0'; i <= '9'; i++ )
+            d_class[i] |= Digit | NumStart;
+        // same as QChar::isSpace for ascii
+        for( int i = '\t'; i <= '\r'; i++ )
+            d_class[i] |= Space;
+        d_class[int(' ')] |= Space;
+        // the first characters of the operators known by tokenTypeFromString
+        const char* ops = "!%&()*+,-/:;<=>[]^|";
+        for( const char* op = ops; *op; op++ )
+            d_class[int(*op)] |= OpStart;
+        d_class[int('"')] |= Quote;
+        d_class[int('`')] |= Quote;
+        d_class[int('\'')] |= Quote;
+        d_class[int('.')] |= NumStart;
+        d_class[int('#')] |= NumStart;
+    }
+};
+
+static const CharClassTable s_chars;
+
+static inline quint8 charClass( char c )
+{
+    return s_chars.d_class[(uchar)c];
+}
+
+static inline bool isLetter( const char* str, const char* end, int* len )
+{
+    const quint8 cc = charClass(*str);
+    if( cc & NonAscii )
+        return QChar::isLetter( decode( str, end, len ) );
+    *len = 1;
+    return cc & Letter;
+}
+
+static inline bool isDigit( const char* str, const char* end, int* len )
+{
+    const quint8 cc = charClass(*str);
+    if( cc & NonAscii )
+        return QChar::isDigit( decode( str, end, len ) );
+    *len = 1;
+    return cc & Digit;
+}
+
+static inline bool isLetterOrNumber( const char* str, const char* end, int* len )
+{
+    const quint8 cc = charClass(*str);
+    if( cc & NonAscii )
+        return QChar::isLetterOrNumber( decode( str, end, len ) );
+    *len = 1;
+    return cc & ( Letter | Digit );
+}
+
+static inline bool isSpace( const char* str, const char* end, int* len )
+{
+    const quint8 cc = charClass(*str);
+    if( cc & NonAscii )
+        return QChar::isSpace( decode( str, end, len ) );
+    *len = 1;
+    return cc & Space;
+}
+
+// perfect hash over the keywords and pseudo-keywords (all plain ascii, between 2 and 10 chars);
+// the coefficients were found by search; if the keyword set in AlgTokenType.h changes, the
+// constructor asserts and new coefficients have to be found.
+struct KeywordTable
+{
+    enum { Slots = 128, MinLen = 2, MaxLen = 10 };
+    const char* d_name[Slots];
+    quint8 d_len[Slots];
+    quint16 d_type[Slots];
+
+    static inline quint32 hash( const char* str, int len )
+    {
+        // & 0xdf folds lower to upper case ascii letters; anything else never matches a keyword
+        return ( len * 5 + ( str[0] & 0xdf ) + ( str[1] & 0xdf ) + ( str[len-1] & 0xdf ) * 17 ) & ( Slots - 1 );
+    }
+    KeywordTable()
+    {
+        ::memset( d_len, 0, sizeof(d_len) );
+        for( int t = TT_Keywords + 1; t < TT_Specials; t++ )
+        {
+            const char* name = tokenTypeString(t);
+            const int len = ::strlen(name);
+            Q_ASSERT( len >= MinLen && len <= MaxLen );
+            const quint32 h = hash( name, len );
+            Q_ASSERT( d_len[h] == 0 ); // collision
+            d_name[h] = name;
+            d_len[h] = len;
+            d_type[h] = t;
+        }
+    }
+};
+
+static const KeywordTable s_keywords;
+
+static TokenType keyword( const char* str, int len )
+{
+    // case insensitive, compares in place
+    if( len < KeywordTable::MinLen || len > KeywordTable::MaxLen )
+        return Tok_Invalid;
+    const quint32 h = KeywordTable::hash( str, len );
+    if( s_keywords.d_len[h] != len )
+        return Tok_Invalid;
+    const char* name = s_keywords.d_name[h];
+    for( int i = 0; i < len; i++ )
+    {
+        if( ( str[i] & 0xdf ) != name[i] )
+            return Tok_Invalid;
+    }
+    return (TokenType)s_keywords.d_type[h];
+}
+
+static const char* skipSpan( const char* p, const char* end )
+{
+    // steps over the string, comment or word at p the same way the scanner does; strings end on
+    // the line they start, COMMENT runs to the next ';' and the text after END to end, else or ';'
+    const uchar c = *p;
+    const bool lquote = c == 0xe2 && end - p > 2 && uchar(p[1]) == 0x80 && uchar(p[2]) == 0x98;
+    if( c == '"' || c == '`' || lquote )
+    {
+        const char* eol = (const char*)::memchr( p, '\n', end - p );
+        if( eol == 0 )
+            eol = end;
+        const char* q = p + ( lquote ? 3 : 1 );
+        while( q < eol )
+        {
+            if( ( c == '"' && *q == '"' ) || ( c == '`' && *q == '\'' ) )
+                return q + 1;
+            if( lquote && uchar(*q) == 0xe2 && eol - q > 2 && uchar(q[1]) == 0x80 && uchar(q[2]) == 0x99 )
+                return q + 3;
+            q++;
+        }
+        return eol;
+    }
+    if( !( charClass(c) & Letter ) )
+        return p + 1;
+    const char* w = p + 1;
+    while( w < end && ( charClass(*w) & ( Letter | Digit ) ) )
+        w++;
+    switch( keyword( p, w - p ) )
+    {
+    case Tok_COMMENT:
+        {
+            const char* semi = (const char*)::memchr( w, ';', end - w );
+            return semi == 0 ? end : semi + 1;
+        }
+    case Tok_END:
+        {
+            const int i = Lexer::findComment2End( p, end - p, w - p );
+            return i == -1 ? end : p + i;
+        }
+    default:
+        return w;
+    }
+}
+
+Lexer::Dialect Lexer::detectDialect(const char* str, int len)
+{
+    // a 'keyword' anywhere in the source selects the quoted keyword dialect, unless it is part
+    // of a comment or string; only the text in front of a candidate is stepped over span by span
+    const char* const end = str + len;
+    const char* done = str;
+    const char* p = (const char*)::memchr( str, '\'', len );
+    while( p != 0 )
+    {
+        while( done < p )
+            done = skipSpan( done, end );
+        const char* w = p + 1;
+        while( w < end && ( charClass(*w) & Letter ) )
+            w++;
+        if( done == p && w < end && *w == '\'' && keyword( p + 1, w - p - 1 ) != Tok_Invalid )
+            return QuotedKeywords;
+        if( w < done )
+            w = done;
+        p = (const char*)::memchr( w, '\'', end - w );
+    }
+    // otherwise the first ascii word which is a keyword gives the case
+    const char* w = str;
+    while( w < end )
+    {
+        if( !( charClass(*w) & Letter ) )
+        {
+            w++;
+            continue;
+        }
+        const char* e = w + 1;
+        while( e < end && ( charClass(*e) & ( Letter | Digit ) ) )
+            e++;
+        if( ( w == str || !( charClass(w[-1]) & NonAscii ) ) && keyword( w, e - w ) != Tok_Invalid )
+            return ::isupper( (uchar)*w ) ? UpperCase : LowerCase;
+        w = e;
+    }
+    return LowerCase;
+}
+
+static inline TokenType unicodeOperator( uint ch )
+{
+    switch( ch )
+    {
+    case L'¬':
+        return Tok_Unot;
+    case L'×':
+        return Tok_Umul;
+    case L'÷':
+        return Tok_Udiv;
+    case L'↑':
+        return Tok_Uexp;
+    case L'∧':
+        return Tok_Uand;
+    case L'∨':
+        return Tok_Uor;
+    case L'≠':
+        return Tok_Uneq;
+    case L'≡':
+        return Tok_Ueq;
+    case L'≤':
+        return Tok_Uleq;
+    case L'≥':
+        return Tok_Ugeq;
+    case L'⊃':
+        return Tok_Uimpl;
+    default:
+        return Tok_Invalid;
+    }
+}
+
+// the values of the unicode operator tokens are interned once and shared by all tokens
+struct UnicodeOpTable
+{
+    QByteArray d_val[Tok_Uimpl - Tok_Unot + 1];
+    UnicodeOpTable()
+    {
+        for( int t = Tok_Unot; t <= Tok_Uimpl; t++ )
+            d_val[t - Tok_Unot] = Symbols::intern( tokenTypeString(t), ::strlen(tokenTypeString(t)) );
+    }
+};
+
+static const UnicodeOpTable s_unicodeOps;
+
+quint32 Lexer::column(const char* pos)
+{
+    if( pos < d_colPos || d_colPos < d_lineStart || d_colPos > d_lineEnd )
+    {
+        d_colPos = d_lineStart;
+        d_colNr = 0;
+    }
+    d_colNr += LineIndex::utf16Len( d_colPos, pos - d_colPos );
+    d_colPos = pos;
+    return d_colNr;
+}
+
+template<bool quotedKeywords>
+Token Lexer::nextTokenImp()
+{
+    if( d_cur == 0 )
+        return token(Tok_Eof, 0);
+    if( d_mode != LexerState::Normal )
+    {
+        // restarted at a line start within a comment
+        if( d_cur >= d_lineEnd )
+        {
+            if( atEnd() )
+                return token( Tok_Eof, 0 );
+            nextLine();
+        }
+        if( d_mode == LexerState::InComment )
+            return comment(true);
+        const Token cmt = comment2();
+        if( cmt.isValid() )
+            return cmt;
+    }
+    skipWhiteSpace();
+
+    while( d_cur >= d_lineEnd )
+    {
+        if( atEnd() )
+            return token( Tok_Eof, 0 );
         nextLine();
         skipWhiteSpace();
     }
-    Q_ASSERT( d_colNr < d_line.size() );
-    while( d_colNr < d_line.size() )
-    {
-        const QChar ch = d_line[d_colNr];
-
-        if( ch == L'¬' )
-            return token( Tok_Unot, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'×' )
-            return token( Tok_Umul, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'÷' )
-            return token( Tok_Udiv, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'↑' )
-            return token( Tok_Uexp, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'∧' )
-            return token( Tok_Uand, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'∨' )
-            return token( Tok_Uor, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'≠' )
-            return token( Tok_Uneq, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'≡' )
-            return token( Tok_Ueq, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'≤' )
-            return token( Tok_Uleq, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'≥' )
-            return token( Tok_Ugeq, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == L'⊃' )
-            return token( Tok_Uimpl, 1, d_line.mid(d_colNr,1).toUtf8() );
-        if( ch == '"' || ch == L'‘' || ch == L'`' )
-            return string();
-        if( ch.isLetter() || ( ch == '\'' && lookAhead().isLetter() ) )
-            // some source code embedds the keywords by ''
-            return ident();
-        if( ch.isDigit() || ch == '.' || ch == L'⏨' || ch == '#' ) // exponential_part starting with 'E' are not supported because ambiguity with ident
+    Q_ASSERT( d_cur < d_lineEnd );
+    if( d_chunk && !syncPoint() )
+        return token( Tok_Eof, 0 );
+    int n;
+    const quint8 cc = charClass(*d_cur);
+    if( !( cc & NonAscii ) )
+    {
+        if( cc & Letter )
+            return ident<quotedKeywords>();
+        if( cc & NumStart ) // exponential_part starting with 'E' are not supported because ambiguity with ident
             return number();
-        // else
-        int pos = 0;
-        const QString part = d_line.mid(d_colNr);
-        TokenType tt = tokenTypeFromString(part.toUtf8(),&pos);
-
-        /*if( tt == Tok_Latt )
-            return comment();
-        else if( d_enableExt && tt == Tok_2Slash )
+        if( cc & OpStart )
         {
-            const int len = d_line.size() - d_colNr;
-            return token( Tok_Comment, len, d_line.mid(d_colNr,len) );
-        }else */if( tt == Tok_Invalid || pos == 0 )
-            return token( Tok_Invalid, 1, QString("unexpected character '%1' %2").arg(ch).arg(ch.unicode()).toUtf8() );
-        else {
-            return token( tt, pos, part.left(pos).toUtf8() );
-        }
+            if( d_cur + 1 < d_lineEnd && isUnderline( d_cur + 1, d_lineEnd ) )
+                return underlinedOperator();
+            int pos = 0;
+            const TokenType tt = tokenTypeFromString( QByteArray::fromRawData( d_cur, d_lineEnd - d_cur ), &pos );
+            if( tt != Tok_Invalid && pos != 0 )
+                return token( tt, pos, getSymbol(d_cur,pos) );
+        }else if( *d_cur == '\'' )
+        {
+            // some source code embedds the keywords by ''
+            if( d_cur + 1 < d_lineEnd && isLetter( d_cur + 1, d_lineEnd, &n ) )
+                return ident<quotedKeywords>();
+        }else if( cc & Quote )
+            return string();
+        return token( Tok_Invalid, 1, QString("unexpected character '%1' %2").
+                      arg(QString::fromLatin1(d_cur,1)).arg(uint(*d_cur)).toUtf8() );
     }
-    Q_ASSERT(false);
-    return token(Tok_Invalid);
+    // else: publication symbols and non-ascii letters and digits
+    const uint ch = decode( d_cur, d_lineEnd, &n );
+
+    const TokenType op = unicodeOperator(ch);
+    if( op != Tok_Invalid )
+        return token( op, n, s_unicodeOps.d_val[op - Tok_Unot] );
+    if( ch == L'‘' )
+        return string();
+    if( QChar::isLetter(ch) )
+        return ident<quotedKeywords>();
+    if( QChar::isDigit(ch) || ch == L'⏨' )
+        return number();
+    // else
+    return token( Tok_Invalid, n, QString("unexpected character '%1' %2").
+                  arg(QString::fromUtf8(d_cur,n)).arg(ch).toUtf8() );
+}
+
+Token Lexer::underlinedOperator()
+{
+    // e.g. ":̲=", where the underlines between the characters of the operator are skipped; the ones after
+    // it are left to skipWhiteSpace like after any other token
+    char op[2];
+    const char* end = d_cur;
+    int len = 0;
+    while( end < d_lineEnd && len < 2 )
+    {
+        if( isUnderline( end, d_lineEnd ) )
+            end += 2;
+        else if( len == 0 || ( charClass(*end) & OpStart ) )
+            op[len++] = *end++;
+        else
+            break;
+    }
+    int pos = 0;
+    const TokenType tt = tokenTypeFromString( QByteArray::fromRawData( op, len ), &pos );
+    if( tt == Tok_Invalid || pos == 0 )
+        return token( Tok_Invalid, 1, QString("unexpected character '%1' %2").
+                      arg(QString::fromLatin1(d_cur,1)).arg(uint(*d_cur)).toUtf8() );
+    // the first character and the underlines after it, and the second character if pos says so
+    end = d_cur + 1;
+    while( end < d_lineEnd && isUnderline( end, d_lineEnd ) )
+        end += 2;
+    if( pos == 2 )
+        end++;
+    return token( tt, end - d_cur, getSymbol(op,pos) );
 }
 
 int Lexer::skipWhiteSpace()
 {
-    const int colNr = d_colNr;
-    while( d_colNr < d_line.size() && d_line[d_colNr].isSpace() )
-        d_colNr++;
-    if( d_colNr == d_line.size() - 1 && d_line[d_colNr] == '\'' )
-        d_colNr++; // some Algol compilers use ' to end lines
-    return d_colNr - colNr;
+    const char* start = d_cur;
+    while( d_cur < d_lineEnd )
+    {
+        int n;
+        if( isSpace( d_cur, d_lineEnd, &n ) )
+            d_cur += n;
+        else if( isUnderline( d_cur, d_lineEnd ) )
+            d_cur += 2; // e.g. underlined blanks in "go to"
+        else
+            break;
+    }
+    if( d_cur == d_lineEnd - 1 && *d_cur == '\'' )
+        d_cur++; // some Algol compilers use ' to end lines
+    return d_cur - start;
 }
 
 void Lexer::nextLine()
 {
-    d_colNr = 0;
     d_lineNr++;
-    d_line = d_in->readLine();
-    static const QChar underline(818);
-    d_line.replace(underline,"");
-
-    if( d_line.endsWith("\r\n") )
-        d_line.chop(2);
-    else if( d_line.endsWith('\n') || d_line.endsWith('\r') || d_line.endsWith('\025') )
-        d_line.chop(1);
+    const char* end = (const char*)::memchr( d_next, '\n', d_end - d_next );
+    while( end == 0 && d_streaming && fill( d_next ) )
+        end = (const char*)::memchr( d_next, '\n', d_end - d_next );
+    const char* start = d_next;
+    if( end )
+    {
+        d_next = end + 1;
+        if( end > start && end[-1] == '\r' )
+            end--;
+    }else
+    {
+        end = d_end;
+        d_next = d_end;
+        if( end > start && ( end[-1] == '\r' || end[-1] == '\025' ) )
+            end--;
+    }
+    d_lineOffset = d_base + ( start - d_buf.constData() );
+    if( d_states )
+        d_states->append( LexerState( d_lineOffset, d_lineNr, d_mode, d_quotedKeywords ) );
+    d_lineStart = d_cur = d_colPos = start;
+    d_lineEnd = end;
+    d_colNr = 0;
 }
 
-QChar Lexer::lookAhead(int off) const
+bool Lexer::fill(const char* keep)
 {
-    if( int( d_colNr + off ) < d_line.size() )
+    // moves what is still needed of the window to its start and reads more from the stream; keeps the
+    // current line by default, and only grows the window if this doesn't leave space to read
+    if( !d_streaming )
+        return false;
+    if( keep == 0 )
+        keep = d_lineStart;
+    const char* const old = d_buf.constData();
+    const int shift = keep - old;
+    const int rest = d_end - keep;
+    if( shift > 0 && rest > 0 )
+        ::memmove( d_buf.data(), keep, rest );
+    if( rest == d_buf.size() )
+        d_buf.resize( d_buf.size() * 2 );
+    qint64 n = d_in->read( d_buf.data() + rest, d_buf.size() - rest );
+    if( n == 0 && d_in->waitForReadyRead(-1) )
+        n = d_in->read( d_buf.data() + rest, d_buf.size() - rest );
+    if( n <= 0 )
     {
-        return d_line[ d_colNr + off ];
-    }else
-        return QChar();
+        d_streaming = false;
+        n = 0;
+    }
+    // all pointers from keep on are moved, the ones in front are no longer needed
+    const char* const buf = d_buf.constData();
+    d_end = buf + rest + n;
+    d_next = buf + ( d_next - old ) - shift;
+    if( d_lineStart >= keep )
+    {
+        d_lineStart = buf + ( d_lineStart - old ) - shift;
+        d_lineEnd = buf + ( d_lineEnd - old ) - shift;
+        d_cur = buf + ( d_cur - old ) - shift;
+        d_colPos = buf + ( d_colPos - old ) - shift;
+    }
+    d_base += shift;
+    return n > 0;
+}
+
+quint32 Lexer::offset(const char* pos) const
+{
+    return d_lineOffset + ( pos - d_lineStart );
 }
 
 static bool pseudoKeyword(int t)
@@ -286,14 +967,15 @@ static bool pseudoKeyword(int t)
 
 Token Lexer::token(TokenType tt, int len, const QByteArray& val)
 {
-    QByteArray v = val;
-    if( tt != Tok_Comment && tt != Tok_Invalid )
-        v = getSymbol(v);
-    Token t( tt, d_lineNr, d_colNr + 1, len, v );
+    if( tt == Tok_Invalid && len == 0 && d_cur < d_lineEnd )
+        decode( d_cur, d_lineEnd, &len );
+    const char* end = qMin( d_cur + len, d_lineEnd > d_cur ? d_lineEnd : d_cur );
+    Token t( tt, d_lineNr, column(d_cur) + 1, LineIndex::utf16Len( d_cur, end - d_cur ), val );
+    t.d_offset = offset(d_cur);
+    t.d_byteLen = offset(end) - t.d_offset;
+    t.d_sourcePath = d_sourcePath;
     if( tt == Tok_Invalid )
     {
-        if( len == 0 )
-            len = 1;
         if( d_err != 0 )
             d_err->error(Errors::Syntax, t.d_sourcePath, t.d_lineNr, t.d_colNr, t.d_val );
     }else if( pseudoKeyword(tt) )
@@ -302,60 +984,65 @@ Token Lexer::token(TokenType tt, int len, const QByteArray& val)
         t.d_code = tt;
     }
     d_lastToken = t;
-    d_colNr += len;
-    t.d_sourcePath = d_sourcePath;
+    d_cur = end;
     return t;
 }
 
-static inline bool isAllLowerCase( const QString& str )
-{
-    for( int i = 0; i < str.size(); i++ )
-    {
-        if( !str[i].isLower() )
-                return false;
-    }
-    return true;
-}
-
+template<bool quotedKeywords>
 Token Lexer::ident()
 {
-    const bool quotedKeyword = lookAhead(0) == '\'';
-    int off = 1;
-    while( true )
+    // in the quoted and underlined keyword dialects words which are neither quoted nor underlined are
+    // never keywords
+    const bool quotedKeyword = *d_cur == '\'';
+    int n, underlines = 0;
+    decode( d_cur, d_lineEnd, &n );
+    const char* end = d_cur + n;
+    while( end < d_lineEnd )
     {
-        const QChar c = lookAhead(off);
-        if( !c.isLetterOrNumber() &&
-                c.unicode() != '_' // extension by RK not in the standard
+        if( isLetterOrNumber( end, d_lineEnd, &n ) ||
+                *end == '_' // extension by RK not in the standard
                 )
+            end += n;
+        else if( isUnderline( end, d_lineEnd ) )
+        {
+            underlines++;
+            end += 2;
+        }else
             break;
-        else
-            off++;
     }
-    if( quotedKeyword && lookAhead(off++) != '\'' )
-        return token( Tok_Invalid, off, "non-terminated quoted keyword" );
-
-    const QString str = d_line.mid(d_colNr, off );
-    Q_ASSERT( !str.isEmpty() );
+    const char* word = d_cur;
+    const char* wordEnd = end;
     if( quotedKeyword )
-        d_quotedKeywords = true;
+    {
+        const bool terminated = end < d_lineEnd && *end == '\'';
+        if( end < d_lineEnd )
+        {
+            decode( end, d_lineEnd, &n );
+            end += n;
+        }
+        if( !terminated )
+            return token( Tok_Invalid, end - d_cur, "non-terminated quoted keyword" );
+        word++;
+    }
+    const int off = end - d_cur;
+    Q_ASSERT( off > 0 );
 
-    int pos = 0;
-    QString keyword = str.toUpper(); // ignore case in keywords (unspecified)
-    if(quotedKeyword)
+    if( wordEnd == word )
+        return token( Tok_Invalid, off, "empty quoted keyword" );
+    Stripped stripped;
+    if( underlines )
     {
-        keyword = keyword.mid(1,keyword.size()-2);
-        if( keyword.isEmpty() )
-            return token( Tok_Invalid, off, "empty quoted keyword" );
+        removeUnderlines( word, wordEnd, stripped );
+        word = stripped.constData();
+        wordEnd = word + stripped.size();
     }
-    TokenType t = tokenTypeFromString( keyword.toUtf8(), &pos );
-    if( t != Tok_Invalid && pos != keyword.size() )
-        t = Tok_Invalid;
+    TokenType t = Tok_Invalid;
+    if( !quotedKeywords || quotedKeyword || underlines )
+        t = keyword( word, wordEnd - word );
     if( quotedKeyword && t == Tok_Invalid )
         return token( Tok_Invalid, off, "invalid quoted keyword" );
-    if( d_quotedKeywords && !quotedKeyword )
-        t = Tok_Invalid; // we found an unquoted ident which looks like a keyword but in a file with quoted keywords.
     if( t == Tok_COMMENT )
-        return comment();
+        return comment(); // starts at the keyword
     if( t == Tok_END )
     {
         const Token res = token(t,off);
@@ -367,83 +1054,315 @@ Token Lexer::ident()
     if( t != Tok_Invalid )
         return token( t, off );
     else
-        return token( Tok_identifier, off, str.toUtf8() );
+        return token( Tok_identifier, off, getSymbol( word, wordEnd - word ) );
+}
+
+static inline const char* skipUnderlines( const char* str, const char* end )
+{
+    while( str < end && isUnderline( str, end ) )
+        str += 2;
+    return str;
 }
 
 Token Lexer::number()
 {
-    int off = 0;
-    while( true )
+    const char* end = d_cur;
+    while( end < d_lineEnd )
     {
-        const QChar c = lookAhead(off);
-        if( !c.isDigit() )
-            break;
+        int n;
+        if( isDigit( end, d_lineEnd, &n ) )
+            end += n;
+        else if( isUnderline( end, d_lineEnd ) )
+            end += 2;
         else
-            off++;
+            break;
     }
     bool isReal = false;
 
-    const int decflen = decimal_fraction(off);
+    const int decflen = decimal_fraction(end);
     if( decflen > 0 )
     {
         isReal = true;
-        off += decflen;
+        end += decflen;
     }else if( decflen < 0 )
         return token( Tok_Invalid, 1, "invalid decimal_number" );
 
-    const int explen = exponential_part(off);
+    const int explen = exponential_part(end);
     if( explen > 0 )
     {
         isReal = true;
-        off += explen;
+        end += explen;
     }else if( explen < 0 )
-        return token( Tok_Invalid, off, "invalid decimal_number" );
+        return token( Tok_Invalid, end - d_cur, "invalid decimal_number" );
+
+    const int off = end - d_cur;
+    Q_ASSERT( off > 0 );
+
+    QByteArray val;
+    if( ::memchr( d_cur, 0xcc, off ) == 0 )
+        val = getSymbol( d_cur, off );
+    else
+    {
+        Stripped stripped;
+        removeUnderlines( d_cur, end, stripped );
+        val = getSymbol( stripped.constData(), stripped.size() );
+    }
+    Token t = token( isReal ? Tok_decimal_number : Tok_unsigned_integer, off, val );
+    const NumberStatus s = decodeNumber( t );
+    if( s != NumberOk )
+        numberError( t, s );
+    return t;
+}
+
+void Lexer::numberError(const Token& t, NumberStatus s)
+{
+    if( d_err == 0 )
+        return;
+    if( s == NumberOverflow )
+        d_err->error( Errors::Lexer, t.d_sourcePath, t.d_lineNr, t.d_colNr,
+                      t.d_type == Tok_unsigned_integer ? "integer out of range" : "real number out of range" );
+    else if( s == NumberUnderflow )
+        d_err->warning( Errors::Lexer, t.d_sourcePath, t.d_lineNr, t.d_colNr, "real number underflows to zero" );
+    else if( s == NumberInexact )
+        d_err->warning( Errors::Lexer, t.d_sourcePath, t.d_lineNr, t.d_colNr,
+                        "real number has more significant digits than a double preserves and is rounded" );
+}
+
+static inline int digitValue( const char* str, const char* end, int* len )
+{
+    const quint8 cc = charClass(*str);
+    if( cc & NonAscii )
+        return QChar::digitValue( decode( str, end, len ) );
+    *len = 1;
+    return cc & Digit ? *str - '0' : -1;
+}
+
+static const double s_pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static double slowDecimal( const char* str, const char* end, int exp10, bool* ok )
+{
+    // all digits of the mantissa followed by the exponent, which QByteArray::toDouble rounds correctly
+    QByteArray num;
+    num.reserve( end - str + 8 );
+    while( str < end )
+    {
+        int n;
+        const int d = digitValue( str, end, &n );
+        if( d >= 0 )
+            num += char( '0' + d );
+        else if( *str != '.' )
+            break;
+        str += n;
+    }
+    if( num.isEmpty() )
+        num += '1';
+    num += 'e';
+    num += QByteArray::number( exp10 );
+    return num.toDouble( ok );
+}
+
+static bool roundTrips( quint64 m, int significant, double r )
+{
+    // true if r printed with the given number of significant digits gives the digits of the mantissa
+    // m, which has the trailing zeros of the literal; e.g. 1234567890123456.0 is stored exactly
+    while( m != 0 && m % 10 == 0 )
+        m /= 10;
+    QByteArray digits = QByteArray::number( r, 'e', significant - 1 );
+    digits.truncate( digits.indexOf( 'e' ) );
+    digits.remove( 1, 1 ); // the decimal point after the first digit
+    return digits == QByteArray::number( m );
+}
 
-    const QString str = d_line.mid(d_colNr, off );
-    Q_ASSERT( !str.isEmpty() );
+Lexer::NumberStatus Lexer::decodeNumber(Token& t)
+{
+    const char* str = t.d_val.constData();
+    const char* const end = str + t.d_val.size();
+    int n;
+    if( t.d_type == Tok_unsigned_integer )
+    {
+        const quint64 max = std::numeric_limits<qint64>::max();
+        quint64 v = 0;
+        for( ; str < end; str += n )
+        {
+            const int d = digitValue( str, end, &n );
+            if( d < 0 )
+                break;
+            if( v > ( max - d ) / 10 )
+            {
+                t.d_int = -1;
+                return NumberOverflow;
+            }
+            v = v * 10 + d;
+        }
+        t.d_int = v;
+        return NumberOk;
+    }
+    if( t.d_type != Tok_decimal_number )
+        return NumberOk;
 
-    if( isReal)
-        return token( Tok_decimal_number, off, str.toUtf8() );
+    // up to 19 significant digits are collected in the mantissa; exp10 is the decimal exponent of its
+    // last digit, and inexact is set if non-zero digits were dropped; significant counts the digits up
+    // to the last non-zero one
+    const char* const start = str;
+    quint64 m = 0;
+    int digits = 0, exp10 = 0, allDigits = 0, fracDigits = 0, sigDigits = 0, significant = 0;
+    bool inexact = false, fraction = false;
+    for( ; str < end; str += n )
+    {
+        const int d = digitValue( str, end, &n );
+        if( d < 0 )
+        {
+            if( *str == '.' && !fraction )
+            {
+                fraction = true;
+                continue;
+            }
+            break;
+        }
+        allDigits++;
+        if( fraction )
+        {
+            fracDigits++;
+            exp10--;
+        }
+        if( m == 0 && d == 0 )
+            continue;
+        sigDigits++;
+        if( d != 0 )
+            significant = sigDigits;
+        if( digits < 19 )
+        {
+            m = m * 10 + d;
+            digits++;
+        }else
+        {
+            exp10++;
+            if( d != 0 )
+                inexact = true;
+        }
+    }
+    int e = 0;
+    if( str < end )
+    {
+        // exponent marker E, e, ⏨ or #
+        decode( str, end, &n );
+        str += n;
+        bool neg = false;
+        if( str < end && ( *str == '+' || *str == '-' ) )
+            neg = *str++ == '-';
+        for( ; str < end; str += n )
+        {
+            const int d = digitValue( str, end, &n );
+            if( d < 0 )
+                break;
+            if( e < 100000 )
+                e = e * 10 + d;
+        }
+        if( neg )
+            e = -e;
+    }
+    if( allDigits == 0 )
+        m = 1; // ⏨3 is 1000
+    exp10 += e;
+
+    double r;
+    if( m == 0 )
+        r = 0.0;
+    else if( !inexact && m <= ( quint64(1) << 53 ) && exp10 >= -22 && exp10 <= 22 )
+        r = exp10 < 0 ? double(m) / s_pow10[-exp10] : double(m) * s_pow10[exp10]; // exact operands, one rounding
+    else if( !inexact && exp10 > 22 && exp10 <= 22 + 15 && m <= ( quint64(1) << 53 ) / quint64(s_pow10[exp10 - 22]) )
+        r = double( m * quint64(s_pow10[exp10 - 22]) ) * 1e22;
     else
-        return token( Tok_unsigned_integer, off, str.toUtf8() );
+    {
+        bool ok;
+        r = slowDecimal( start, end, e - fracDigits, &ok );
+        if( !ok ) // out of the range of double
+            r = digits + exp10 > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+    }
+    t.d_real = r;
+    if( qIsInf(r) )
+        return NumberOverflow;
+    if( r == 0.0 && m != 0 )
+        return NumberUnderflow;
+    if( significant > std::numeric_limits<double>::digits10 && ( inexact || !roundTrips( m, significant, r ) ) )
+        return NumberInexact;
+    return NumberOk;
 }
 
-Token Lexer::comment()
+// Comment tokens only carry their span in the source; the text is not collected since it is rarely
+// used, and can be recovered from the span (see SourceRegistry::value). The length is still the one of
+// the former text, i.e. the lines joined by '\n', where no line break is counted in front of the
+// first non-empty line.
+struct CommentLen
 {
-    // COMMENT detected
-    const int startLine = d_lineNr;
-    const int startCol = d_colNr;
-    static const int symLen = ::strlen("comment");
+    quint32 d_len;
+    bool d_empty;
+    CommentLen():d_len(0),d_empty(true){}
+    void add( const char* from, const char* to )
+    {
+        if( !d_empty )
+            d_len++;
+        if( from < to )
+        {
+            d_len += LineIndex::utf16Len( from, to - from );
+            d_empty = false;
+        }
+    }
+};
+
+Token Lexer::comment(bool resumed)
+{
+    // COMMENT detected, d_cur points to the keyword, or resumed at the start of a line in the comment
+    const quint32 startLine = d_lineNr;
+    const quint32 startCol = column(d_cur);
+    const quint32 startOffset = offset(d_cur);
+    const char* symEnd = d_cur;
+    while( !resumed && symEnd < d_lineEnd )
+    {
+        if( ::isalpha( (uchar)*symEnd ) || *symEnd == '\'' )
+            symEnd++;
+        else if( isUnderline( symEnd, d_lineEnd ) )
+            symEnd += 2;
+        else
+            break;
+    }
+    const int symLen = LineIndex::utf16Len( d_cur, symEnd - d_cur );
 
     if( !d_packComments )
-        d_colNr += symLen;
+        d_cur = symEnd;
+    const quint32 textCol = column(d_cur);
+    const quint32 textOffset = offset(d_cur);
 
-    int semiPos = -1;
-    QString str;
-    while( semiPos == -1 )
+    const char* semiPos = 0;
+    CommentLen len;
+    d_mode = LexerState::InComment;
+    while( semiPos == 0 )
     {
-        semiPos = d_line.indexOf(";", d_colNr);
-        if( semiPos != -1 )
+        semiPos = (const char*)::memchr( d_cur, ';', d_lineEnd - d_cur );
+        if( semiPos != 0 )
         {
             semiPos += 1;
-            if( !str.isEmpty() )
-                str += '\n';
-            str += d_line.mid(d_colNr,semiPos-d_colNr);
+            len.add( d_cur, semiPos );
             break;
         }else
         {
-            if( !str.isEmpty() )
-                str += '\n';
-            str += d_line.mid(d_colNr);
-            if( d_in->atEnd() )
+            len.add( d_cur, d_lineEnd );
+            if( atEnd() )
                 break;
         }
         nextLine();
     }
-    if( d_packComments && semiPos == -1 && d_in->atEnd() )
+    if( semiPos )
+        d_mode = LexerState::Normal;
+    const quint32 endOffset = offset( semiPos ? semiPos : d_lineEnd );
+    if( d_packComments && semiPos == 0 && atEnd() )
     {
-        d_colNr = d_line.size();
-        Token t( Tok_Invalid, startLine, startCol + 1, str.size(), tr("non-terminated comment").toLatin1() );
+        d_cur = d_lineEnd;
+        Token t( Tok_Invalid, startLine, startCol + 1, len.d_len, tr("non-terminated comment").toLatin1() );
+        t.d_offset = startOffset;
+        t.d_byteLen = endOffset - startOffset;
+        t.d_sourcePath = d_sourcePath;
         if( d_err )
             d_err->error(Errors::Syntax, t.d_sourcePath, t.d_lineNr, t.d_colNr, t.d_val );
         return t;
@@ -452,133 +1371,518 @@ Token Lexer::comment()
     Token t;
     if( d_packComments )
     {
-        t = Token(Tok_Comment,startLine, startCol + 1, str.size(), str.toUtf8() );
-        d_colNr += str.size();
+        d_cur = semiPos;
+        if( d_ignoreComments )
+            return Token(Tok_Comment); // dropped by nextToken anyway
+        t = Token(Tok_Comment,startLine, startCol + 1, len.d_len );
+        t.d_offset = startOffset;
+        t.d_byteLen = endOffset - startOffset;
         t.d_sourcePath = d_sourcePath;
         d_lastToken = t;
     }else
     {
-        t = Token( Tok_COMMENT, startLine, startCol + 1, symLen );
+        if( !resumed )
+        {
+            t = Token( Tok_COMMENT, startLine, startCol + 1, symLen );
+            t.d_offset = startOffset;
+            t.d_byteLen = textOffset - startOffset;
+            t.d_sourcePath = d_sourcePath;
+        }
+        d_cur = d_lineEnd;
 
-        // also send Tok_Comment for empty strings because "comment" could be followed immediately by \n
-        Token t2( Tok_Comment, startLine, startCol + 1 + symLen, str.size(), str.toUtf8() );
-        t2.d_sourcePath = d_sourcePath;
-        d_lastToken = t2;
-        d_colNr += symLen + str.size();
-        d_buffer.append( t2 );
+        if( !d_ignoreComments )
+        {
+            // also send Tok_Comment for empty strings because "comment" could be followed immediately by \n
+            Token t2( Tok_Comment, startLine, textCol + 1, len.d_len );
+            t2.d_offset = textOffset;
+            t2.d_byteLen = endOffset - textOffset;
+            t2.d_sourcePath = d_sourcePath;
+            d_lastToken = t2;
+            if( resumed )
+                t = t2;
+            else
+                d_buffer.push_back( t2 );
+        }else if( resumed )
+            t = Token(Tok_Comment); // dropped by nextToken
 
-        if( semiPos != -1 )
+        if( semiPos != 0 )
         {
-            Token t(Tok_Semi,d_lineNr, semiPos - 1 + 1, 1 );
+            Token t(Tok_Semi,d_lineNr, column(semiPos - 1) + 1, 1 );
+            t.d_offset = endOffset - 1;
+            t.d_byteLen = 1;
             t.d_sourcePath = d_sourcePath;
             d_lastToken = t;
-            d_buffer.append( t );
-            d_colNr = semiPos;
+            d_buffer.push_back( t );
+            d_cur = semiPos;
         }
     }
     return t;
 }
 
+// The end comment extends up to the next 'end', 'END', 'else', 'ELSE' as a separate word or up to
+// the next ';', i.e. the same as the former QRegExp("\\b(end|END|else|ELSE)\\b|;"); word characters
+// are letters, numbers, marks and '_' as with QRegExp.
+
+static inline bool isWordChar( uint ch )
+{
+    return QChar::isLetterOrNumber(ch) || QChar::isMark(ch) || ch == '_';
+}
+
+static inline bool wordBefore( const char* str, int i )
+{
+    if( i == 0 )
+        return false;
+    const uchar c = str[i-1];
+    if( c < 0x80 )
+        return ( charClass(c) & ( Letter | Digit ) ) || c == '_';
+    int start = i - 1;
+    while( start > 0 && ( (uchar)str[start] & 0xc0 ) == 0x80 )
+        start--;
+    int n;
+    return isWordChar( decode( str + start, str + i, &n ) );
+}
+
+static inline bool wordAfter( const char* str, int len, int i )
+{
+    if( i >= len )
+        return false;
+    const uchar c = str[i];
+    if( c < 0x80 )
+        return ( charClass(c) & ( Letter | Digit ) ) || c == '_';
+    int n;
+    return isWordChar( decode( str + i, str + len, &n ) );
+}
+
+static inline bool wordBefore( const QChar* str, int i )
+{
+    return i > 0 && isWordChar( str[i-1].unicode() );
+}
+
+static inline bool wordAfter( const QChar* str, int len, int i )
+{
+    return i < len && isWordChar( str[i].unicode() );
+}
+
+static inline uint unicode( char c )
+{
+    return uchar(c);
+}
+
+static inline uint unicode( QChar c )
+{
+    return c.unicode();
+}
+
+static inline int find( const char* str, int from, int to, char c )
+{
+    const char* p = (const char*)::memchr( str + from, c, to - from );
+    return p ? p - str : to;
+}
+
+static inline int find( const QChar* str, int from, int to, char c )
+{
+    while( from < to && str[from].unicode() != c )
+        from++;
+    return from;
+}
+
+static inline int skipUnderlines( const char* str, int len, int i )
+{
+    while( i + 1 < len && uchar(str[i]) == 0xcc && uchar(str[i+1]) == 0xb2 )
+        i += 2;
+    return i;
+}
+
+static inline int skipUnderlines( const QChar* str, int len, int i )
+{
+    while( i < len && str[i].unicode() == 0x332 )
+        i++;
+    return i;
+}
+
+template<typename C>
+static inline bool matches( const C* str, int len, int i, const char* word, int wordLen )
+{
+    // the word may be underlined
+    i = skipUnderlines( str, len, i + 1 );
+    for( int j = 1; j < wordLen; j++ ) // str[i] == word[0] is already known
+    {
+        if( i >= len || unicode( str[i] ) != uchar( word[j] ) )
+            return false;
+        i = skipUnderlines( str, len, i + 1 );
+    }
+    return !wordAfter( str, len, i );
+}
+
+template<typename C>
+static int comment2End( const C* str, int len, int from )
+{
+    const int semi = find( str, from, len, ';' );
+    // only the 'e' and 'E' in front of the next ';' are candidates
+    int lower = find( str, from, semi, 'e' );
+    int upper = find( str, from, semi, 'E' );
+    while( lower < semi || upper < semi )
+    {
+        if( lower < upper )
+        {
+            if( !wordBefore( str, lower ) &&
+                    ( matches( str, len, lower, "end", 3 ) || matches( str, len, lower, "else", 4 ) ) )
+                return lower;
+            lower = find( str, lower + 1, semi, 'e' );
+        }else
+        {
+            if( !wordBefore( str, upper ) &&
+                    ( matches( str, len, upper, "END", 3 ) || matches( str, len, upper, "ELSE", 4 ) ) )
+                return upper;
+            upper = find( str, upper + 1, semi, 'E' );
+        }
+    }
+    return semi < len ? semi : -1;
+}
+
+int Lexer::findComment2End(const char* utf8, int len, int from)
+{
+    return comment2End( utf8, len, from );
+}
+
+int Lexer::findComment2End(const QChar* str, int len, int from)
+{
+    return comment2End( str, len, from );
+}
+
 Token Lexer::comment2()
 {
     // passed END
-    const int startLine = d_lineNr;
-    const int startCol = d_colNr;
-
-    QRegExp re("\\b(end|END|else|ELSE)\\b|;"); // any sequence not containing 'end' or ';' or 'else'
+    const quint32 startLine = d_lineNr;
+    const quint32 startCol = column(d_cur);
+    const quint32 startOffset = offset(d_cur);
 
-    int pos = -1;
-    QString str;
-    while( pos == -1 )
+    const char* pos = 0;
+    CommentLen len;
+    d_mode = LexerState::InEndComment;
+    while( pos == 0 )
     {
-        pos = d_line.indexOf(re, d_colNr);
-        if( pos != -1 )
+        // the whole line is passed to see the word boundary in front of d_cur
+        const int i = findComment2End( d_lineStart, d_lineEnd - d_lineStart, d_cur - d_lineStart );
+        if( i != -1 )
         {
-            if( !str.isEmpty() )
-                str += '\n';
-            str += d_line.mid(d_colNr,pos-d_colNr);
+            pos = d_lineStart + i;
+            len.add( d_cur, pos );
             break;
         }else
         {
-            if( !str.isEmpty() )
-                str += '\n';
-            str += d_line.mid(d_colNr);
-            if( d_in->atEnd() )
+            len.add( d_cur, d_lineEnd );
+            if( atEnd() )
                 break;
         }
         nextLine();
     }
-    if( pos == -1 && d_in->atEnd() )
-        pos = d_line.size();
+    if( pos == 0 && atEnd() )
+        pos = d_lineEnd;
+    else
+        d_mode = LexerState::Normal;
+    d_cur = pos;
+    if( len.d_empty || d_ignoreComments )
+        return Token();
 
     // Col + 1 weil wir immer bei Spalte 1 beginnen, nicht bei Spalte 0
-    Token t( ( str.isEmpty() ? Tok_Invalid : Tok_Comment ), startLine, startCol + 1, str.size(), str.toUtf8() );
+    Token t( Tok_Comment, startLine, startCol + 1, len.d_len );
+    t.d_offset = startOffset;
+    t.d_byteLen = offset(pos) - startOffset;
     t.d_sourcePath = d_sourcePath;
     d_lastToken = t;
-    d_colNr = pos;
     return t;
 }
 
 Token Lexer::string()
 {
-    const QChar other = lookAhead(0) == L'‘' ? L'’' : ( lookAhead(0) == L'`' ? L'\'' : L'"' );
-    int off = 1;
+    int n;
+    const uint first = decode( d_cur, d_lineEnd, &n );
+    const uint other = first == L'‘' ? L'’' : ( first == L'`' ? L'\'' : L'"' );
+    const char* end = d_cur + n;
+    bool underlined = false;
     while( true )
     {
-        const QChar c = lookAhead(off);
-        off++;
+        if( end >= d_lineEnd )
+            return token( Tok_Invalid, end - d_cur, "non-terminated string" );
+        const uint c = decode( end, d_lineEnd, &n );
+        end += n;
         if( c == other )
             break;
         if( c == 0 )
-            return token( Tok_Invalid, off, "non-terminated string" );
+            return token( Tok_Invalid, end - d_cur, "non-terminated string" );
+        if( c == 0x332 )
+            underlined = true;
     }
-    const QString str = d_line.mid(d_colNr, off );
-    return token( Tok_string, off, str.toUtf8() );
+    const int off = end - d_cur;
+    if( !underlined )
+        return token( Tok_string, off, getSymbol( d_cur, off ) );
+    Stripped stripped;
+    removeUnderlines( d_cur, end, stripped );
+    return token( Tok_string, off, getSymbol( stripped.constData(), stripped.size() ) );
 }
 
-int Lexer::exponential_part(int off)
+int Lexer::exponential_part(const char* pos)
 {
-    int origOff = off;
-    QChar o1 = lookAhead(off);
+    const char* end = pos;
+    if( end >= d_lineEnd )
+        return 0;
+    int n;
+    const uint o1 = decode( end, d_lineEnd, &n );
     if( o1 == 'E' || o1 == 'e' || o1 == L'⏨' || o1 == '#' )
     {
-        off++;
-        QChar o = lookAhead(off);
-        if( o == '+' || o == '-' )
-        {
-            off++;
-            o = lookAhead(off);
-        }
-        if( !o.isDigit() )
+        end = skipUnderlines( end + n, d_lineEnd );
+        if( end < d_lineEnd && ( *end == '+' || *end == '-' ) )
+            end = skipUnderlines( end + 1, d_lineEnd );
+        if( end >= d_lineEnd || !isDigit( end, d_lineEnd, &n ) )
             return -1; // token( Tok_Invalid, off, "invalid real" );
-        while( true )
+        while( end < d_lineEnd )
         {
-            const QChar c = lookAhead(off);
-            if( !c.isDigit() )
-                break;
+            if( isDigit( end, d_lineEnd, &n ) )
+                end += n;
+            else if( isUnderline( end, d_lineEnd ) )
+                end += 2;
             else
-                off++;
+                break;
         }
     }
-    return off - origOff;
+    return end - pos;
 }
 
-int Lexer::decimal_fraction(int off)
+int Lexer::decimal_fraction(const char* pos)
 {
-    int origOff = off;
-    QChar o1 = lookAhead(off);
-    if( o1 == '.' )
+    const char* end = pos;
+    if( end < d_lineEnd && *end == '.' )
     {
-        off++;
-        while( true )
+        end++;
+        while( end < d_lineEnd )
         {
-            const QChar c = lookAhead(off);
-            if( !c.isDigit() )
+            int n;
+            if( isDigit( end, d_lineEnd, &n ) )
+                end += n;
+            else if( isUnderline( end, d_lineEnd ) )
+                end += 2;
+            else
                 break;
+        }
+    }
+    return end - pos;
+}
+
+// Parallel lexing: the buffer is split at line starts into chunks which are lexed concurrently,
+// each one speculatively starting in the normal state (not in a comment), and all in the dialect
+// detected for the whole buffer. Strings cannot span lines, but comments can. Each chunk lexer
+// continues past the end of its chunk up to the next token start, and records the offset of each
+// token start (i.e. each call of nextTokenImp in the normal state, which excludes the comment after
+// END). The lexer state at such a point only depends on the offset. The chunks are then joined in
+// order: if the sequential lexer reaches a token start which the next chunk also has, the remaining
+// tokens of the chunk are taken over; otherwise the tokens are relexed from there until both agree
+// again.
+
+namespace Alg
+{
+struct Lexer::Chunk
+{
+    struct Sync
+    {
+        quint32 d_offset;
+        int d_index; // the number of tokens lexed before this point
+    };
+    quint32 d_start, d_end; // byte range in the buffer; d_start is a line start
+    quint32 d_stop; // the offset of the token start where the chunk lexer stopped
+    QList<Token> d_tokens;
+    QVector<Sync> d_syncs; // ascending offsets
+    const Chunk* d_match; // stop at the first token start which agrees with this chunk
+    Chunk():d_start(0),d_end(0),d_stop(0),d_match(0){}
+    int find( quint32 offset ) const
+    {
+        int lo = 0, hi = d_syncs.size();
+        while( lo < hi )
+        {
+            const int mid = ( lo + hi ) / 2;
+            if( d_syncs[mid].d_offset < offset )
+                lo = mid + 1;
             else
-                off++;
+                hi = mid;
         }
+        if( lo < d_syncs.size() && d_syncs[lo].d_offset == offset )
+            return lo;
+        return -1;
+    }
+};
+
+class LexChunkTask : public QRunnable
+{
+public:
+    Lexer* d_lex;
+    Lexer::Chunk* d_chunk;
+    const LineIndex* d_lines;
+    LexChunkTask( Lexer* l, Lexer::Chunk* c, const LineIndex* i ):d_lex(l),d_chunk(c),d_lines(i) {}
+    void run()
+    {
+        d_lex->seek( d_chunk->d_start, *d_lines );
+        d_lex->lexChunk( d_chunk );
     }
-    return off - origOff;
+};
 }
 
+bool Lexer::syncPoint()
+{
+    // returns false if the chunk lexer has to stop here
+    const quint32 off = offset(d_cur);
+    if( d_chunk->d_match && !d_chunk->d_syncs.isEmpty() && d_chunk->d_match->find( off ) != -1 )
+    {
+        d_chunk->d_stop = off;
+        return false;
+    }
+    Chunk::Sync s;
+    s.d_offset = off;
+    s.d_index = d_chunk->d_tokens.size();
+    d_chunk->d_syncs.append( s );
+    if( off >= d_chunk->d_end )
+    {
+        d_chunk->d_stop = off;
+        return false;
+    }
+    return true;
+}
+
+void Lexer::seek(quint32 offset, const LineIndex& lines)
+{
+    const quint32 line = lines.line( offset );
+    d_next = d_buf.constData() + lines.lineStart( line );
+    d_lineNr = line - 1;
+    nextLine();
+    while( d_cur < d_lineEnd && this->offset(d_cur) < offset )
+        d_cur++;
+}
+
+void Lexer::lexChunk(Lexer::Chunk* c)
+{
+    d_chunk = c;
+    c->d_stop = d_buf.size();
+    Token t = nextToken();
+    while( t.d_type != Tok_Eof )
+    {
+        c->d_tokens.append( t );
+        t = nextToken();
+    }
+    d_chunk = 0;
+}
+
+QList<Token> Lexer::tokensParallel(const QByteArray& code, const QString& path, int threads)
+{
+    if( threads <= 0 )
+        threads = QThread::idealThreadCount();
+    const quint32 minChunkSize = 256 * 1024;
+    const int count = qMin( threads * 4, int( code.size() / minChunkSize ) );
+    if( count <= 1 )
+    {
+        Lexer l;
+        l.setIgnoreComments( d_ignoreComments );
+        l.setPackComments( d_packComments );
+        l.setErrors( d_err );
+        l.setBuffer( code, path );
+        QList<Token> res;
+        Token t = l.nextToken();
+        while( t.d_type != Tok_Eof )
+        {
+            res.append( t );
+            t = l.nextToken();
+        }
+        return res;
+    }
+
+    const LineIndex lines( code );
+    const Dialect dialect = detectDialect( code.constData(), code.size() );
+    QVector<Chunk> chunks;
+    chunks.reserve( count );
+    quint32 start = 0;
+    for( int i = 0; i < count && start < quint32(code.size()); i++ )
+    {
+        Chunk c;
+        c.d_start = start;
+        if( i == count - 1 )
+            c.d_end = code.size();
+        else
+        {
+            // chunks start at line starts
+            const quint32 target = qMax( start + 1, quint32( quint64(code.size()) * ( i + 1 ) / count ) );
+            c.d_end = target < quint32(code.size()) ? lines.lineStart( lines.line( target ) + 1 ) : code.size();
+            if( c.d_end <= start )
+                c.d_end = code.size();
+        }
+        chunks.append( c );
+        start = c.d_end;
+    }
+
+    QList<Lexer*> lexers;
+    for( int i = 0; i < chunks.size(); i++ )
+    {
+        Lexer* l = new Lexer();
+        l->setIgnoreComments( d_ignoreComments );
+        l->setPackComments( d_packComments );
+        l->setSource( code, path );
+        l->setDialect( dialect );
+        lexers.append( l );
+    }
+    QThreadPool pool;
+    pool.setMaxThreadCount( threads );
+    for( int i = 0; i < chunks.size(); i++ )
+        pool.start( new LexChunkTask( lexers[i], &chunks[i], &lines ) );
+    pool.waitForDone();
+    qDeleteAll( lexers );
+
+    // join the chunks; the first one started with the correct state
+    int total = 0;
+    for( int j = 0; j < chunks.size(); j++ )
+        total += chunks[j].d_tokens.size();
+    QList<Token> res = chunks.first().d_tokens;
+    res.reserve( total );
+    quint32 stop = chunks.first().d_stop;
+    int i = 1;
+    while( stop < quint32(code.size()) )
+    {
+        while( i < chunks.size() && chunks[i].d_end <= stop )
+            i++;
+        Q_ASSERT( i < chunks.size() );
+        const Chunk& c = chunks[i];
+        const int k = c.find( stop );
+        if( k != -1 )
+        {
+            for( int j = c.d_syncs[k].d_index; j < c.d_tokens.size(); j++ )
+                res.append( c.d_tokens[j] );
+            stop = c.d_stop;
+            i++;
+        }else
+        {
+            // the speculation failed; relex until we meet a token start of the chunk or leave it
+            Chunk r;
+            r.d_end = c.d_end;
+            r.d_match = &c;
+            Lexer l;
+            l.setIgnoreComments( d_ignoreComments );
+            l.setPackComments( d_packComments );
+            l.setSource( code, path );
+            l.setDialect( dialect );
+            l.seek( stop, lines );
+            l.lexChunk( &r );
+            res += r.d_tokens;
+            stop = r.d_stop;
+        }
+    }
+    if( d_err )
+    {
+        foreach( const Token& t, res )
+        {
+            if( t.d_type == Tok_Invalid )
+                d_err->error(Errors::Syntax, t.d_sourcePath, t.d_lineNr, t.d_colNr, t.d_val );
+            else if( ( t.d_type == Tok_unsigned_integer && t.d_int < 0 ) || t.d_type == Tok_decimal_number )
+            {
+                Token tmp = t;
+                numberError( tmp, decodeNumber( tmp ) );
+            }
+        }
+    }
+    return res;
+}
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <Algol/AlgToken.h>
 #include <QHash>
+#include <QVector>
 
 class QIODevice;
 
@@ -30,52 +31,145 @@ namespace Alg
 {
     class Errors;
     class FileCache;
+    class SourceRegistry;
+    class LineIndex;
+
+    struct LexerState
+    {
+        // what the lexer needs to resume lexing at the start of a line, see Lexer::restart()
+        enum Mode { Normal, InComment, InEndComment }; // InComment continues up to ';', InEndComment after END
+        quint32 d_offset; // of the line start in the source buffer
+        quint32 d_lineNr;
+        quint8 d_mode;
+        bool d_quotedKeywords;
+        LexerState(quint32 offset = 0, quint32 line = 1, quint8 mode = Normal, bool quoted = false):
+            d_offset(offset),d_lineNr(line),d_mode(mode),d_quotedKeywords(quoted){}
+        // mode and quoted keywords only, e.g. for QSyntaxHighlighter::setCurrentBlockState
+        int flags() const { return d_mode | ( d_quotedKeywords ? 4 : 0 ); }
+        static LexerState fromFlags( int f ) { return LexerState( 0, 1, f & 3, f & 4 ); }
+    };
 
     class Lexer : public QObject
     {
     public:
+        // QuotedKeywords: keywords are written 'BEGIN' and unquoted words are identifiers; otherwise
+        // keywords are case insensitive, and the case of the first one gives Upper- or LowerCase.
+        // UnderlinedKeywords is never detected: keywords are underlined with U+0332 and other words are
+        // identifiers; it lexes the same as QuotedKeywords, where underlined words are keywords too
+        enum Dialect { LowerCase, UpperCase, QuotedKeywords, UnderlinedKeywords };
+        // to be incremented when the tokens for a given source and options change; see TokenCache
+        enum { Version = 2 };
         explicit Lexer(QObject *parent = 0);
 
+        // devices which are neither QBuffer nor a file owned by the lexer (e.g. stdin or a pipe) are read
+        // through a window which only holds the current line and what follows, unless there is a registry
         void setStream( QIODevice*, const QString& sourcePath );
         bool setStream(const QString& sourcePath);
+        void setBuffer( const QByteArray& utf8, const QString& sourcePath ); // zero-copy, buffer is shared, not copied
+        // e.g. QString::constData(); encoded to utf-8 in a buffer reused by subsequent calls. The d_offset and
+        // d_byteLen of the tokens count QChars of str instead of bytes; relex, the logged states and the
+        // registry still refer to the utf-8 encoding
+        void setBuffer( const QChar* str, int len, const QString& sourcePath = QString() );
         void setErrors(Errors* p) { d_err = p; }
         void setCache(FileCache* p) { d_fcache = p; }
-        void setIgnoreComments( bool b ) { d_ignoreComments = b; }
+        void setRegistry(SourceRegistry* p) { d_registry = p; } // each source passed to the lexer is registered
+        quint32 fileId() const { return d_fileId; } // of the current source in the registry, or 0
+        void setIgnoreComments( bool b ) { d_ignoreComments = b; } // comment tokens have no d_val, only their span
+        bool ignoreComments() const { return d_ignoreComments; }
         void setPackComments( bool b ) { d_packComments = b; }
+        bool packComments() const { return d_packComments; }
+        void setDialect( Dialect ); // overrides the dialect detected by setBuffer or setStream
+        Dialect dialect() const { return (Dialect)d_dialect; }
+        static Dialect detectDialect( const char* utf8, int len );
+
+        void setStateLog( QVector<LexerState>* p ) { d_states = p; } // records the state at each line start
+        LexerState state() const; // at the start of the line following the current one
+        void restart( const LexerState& ); // continues lexing the current buffer at the given line start
+        // updates the tokens and logged states of the previous source after [from, from + removed) was
+        // replaced by added bytes, which gives code; only the lines up to the point where the lexer
+        // state converges with the logged one are relexed; returns the number of relexed tokens
+        int relex( const QByteArray& code, quint32 from, quint32 removed, quint32 added,
+                   QList<Token>& tokens, QVector<LexerState>& states, const QString& sourcePath = QString() );
 
         Token nextToken();
-        Token peekToken(quint8 lookAhead = 1);
+        const Token& peekToken(quint8 lookAhead = 1); // valid until the next call of nextToken or peekToken
+        Token next() { return nextToken(); } // Scanner::next for ParserT without a virtual call
         QList<Token> tokens( const QString& code );
         QList<Token> tokens( const QByteArray& code, const QString& path = QString() );
+        // lexes chunks of the source on a thread pool; returns the same tokens as calling nextToken
+        // until Eof (the Eof token excluded, invalid tokens included); threads == 0 is the ideal count
+        QList<Token> tokensParallel( const QByteArray& code, const QString& path = QString(), int threads = 0 );
         static QByteArray getSymbol( const QByteArray& );
+        static QByteArray getSymbol( const char* str, int len );
+        // position of the 'end', 'else' or ';' which terminates the comment after END, or -1
+        static int findComment2End( const char* utf8, int len, int from = 0 );
+        static int findComment2End( const QChar* str, int len, int from = 0 );
+        // NumberInexact: the real has more significant digits than a double preserves and was rounded
+        enum NumberStatus { NumberOk, NumberOverflow, NumberUnderflow, NumberInexact };
+        // sets d_int or d_real of a Tok_unsigned_integer or Tok_decimal_number from d_val
+        static NumberStatus decodeNumber( Token& );
     protected:
-        Token nextTokenImp();
+        template<bool quotedKeywords> Token nextTokenImp();
         int skipWhiteSpace();
         void nextLine();
-        QChar lookAhead(int off = 1) const;
-        Token token(TokenType tt, int len = 1, const QByteArray &val = QByteArray());
-        Token ident();
+        bool atEnd() { return d_next >= d_end && !fill(); }
+        bool fill( const char* keep = 0 );
+        void releaseStream();
+        quint32 column( const char* pos );
+        quint32 offset( const char* pos ) const;
+        Token token(TokenType tt, int len = 1, const QByteArray &val = QByteArray()); // len in bytes from d_cur
+        template<bool quotedKeywords> Token ident();
         Token number();
-        Token comment();
+        Token comment( bool resumed = false );
         Token comment2();
         Token string();
-        int exponential_part(int off);
-        int decimal_fraction(int off);
+        Token underlinedOperator();
+        void toUtf16( Token& );
+        int exponential_part(const char* pos);
+        int decimal_fraction(const char* pos);
+        void numberError( const Token&, NumberStatus );
+        struct Chunk;
+        friend class LexChunkTask;
+        void setSource( const QByteArray& utf8, const QString& sourcePath ); // setBuffer without dialect detection
+        void seek( quint32 offset, const LineIndex& );
+        void lexChunk( Chunk* );
+        bool syncPoint();
     private:
         QIODevice* d_in;
         Errors* d_err;
         FileCache* d_fcache;
+        SourceRegistry* d_registry;
+        quint32 d_fileId;
+        QByteArray d_buf; // the whole source in utf-8, possibly raw data of a mapped file owned by d_in,
+                          // or the window of a stream
+        quint32 d_base; // stream offset of d_buf
+        const char* d_end; // end of d_buf
+        const char* d_next; // start of the line following the current one
+        const char* d_lineStart; // current line in d_buf, without terminator
+        const char* d_lineEnd;
+        const char* d_cur; // current read position in the current line
+        const char* d_colPos; // d_colNr is the column in utf-16 units of d_colPos
+        quint32 d_lineOffset; // byte offset of d_lineStart in d_buf
         quint32 d_lineNr;
-        quint16 d_colNr;
+        quint32 d_colNr;
+        QByteArray d_encoded; // utf-16 sources passed to setBuffer
+        quint32 d_utf16Byte, d_utf16Off; // byte and QChar offset of the last token mapped by toUtf16
         QString d_sourcePath;
-        QString d_line;
-        QList<Token> d_buffer;
-        static QHash<QByteArray,QByteArray> d_symbols;
+        TokenRing d_buffer;
+        QVector<LexerState>* d_states;
         Token d_lastToken;
+        Token (Lexer::*d_scan)(); // nextTokenImp for the dialect
         bool d_quotedKeywords;
+        quint8 d_dialect;
+        quint8 d_mode; // LexerState::Mode
+        bool d_streaming; // d_in is read through the window d_buf
         bool d_ignoreComments;  // don't deliver comment tokens
         bool d_packComments;    // Only deliver one Tok_Comment for (*...*) instead of Tok_Latt and Tok_Ratt
+        Chunk* d_chunk; // only set while lexing a chunk in tokensParallel
+        bool d_utf16; // the source was passed as QChars, see toUtf16
     };
 }
 
+Q_DECLARE_TYPEINFO(Alg::LexerState, Q_PRIMITIVE_TYPE);
+
 #endif // ALGLEXER_H
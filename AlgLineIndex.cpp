@@ -0,0 +1,81 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "AlgLineIndex.h"
+#include <string.h>
+using namespace Alg;
+
+void LineIndex::build(const QByteArray& utf8)
+{
+    d_buf = utf8;
+    d_starts.clear();
+    d_starts.reserve( utf8.size() / 32 + 1 );
+    d_starts.append( 0 );
+    const char* start = d_buf.constData();
+    const char* end = start + d_buf.size();
+    const char* p = start;
+    // memchr is vectorized by the C library
+    while( ( p = (const char*)::memchr( p, '\n', end - p ) ) != 0 )
+    {
+        p++;
+        d_starts.append( p - start );
+    }
+}
+
+quint32 LineIndex::lineStart(quint32 line) const
+{
+    if( line == 0 || line > quint32(d_starts.size()) )
+        return 0;
+    return d_starts[line-1];
+}
+
+quint32 LineIndex::line(quint32 offset) const
+{
+    // index of the last line start <= offset
+    int lo = 0, hi = d_starts.size();
+    while( hi - lo > 1 )
+    {
+        const int mid = ( lo + hi ) / 2;
+        if( d_starts[mid] <= offset )
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo + 1;
+}
+
+quint32 LineIndex::column(quint32 offset) const
+{
+    quint32 l, c;
+    position( offset, &l, &c );
+    return c;
+}
+
+void LineIndex::position(quint32 offset, quint32* line, quint32* col) const
+{
+    if( d_starts.isEmpty() )
+    {
+        *line = *col = 0;
+        return;
+    }
+    *line = this->line( offset );
+    const quint32 start = d_starts[*line-1];
+    offset = qMin( offset, quint32(d_buf.size()) );
+    *col = utf16Len( d_buf.constData() + start, offset - start ) + 1;
+}
@@ -0,0 +1,68 @@
+#ifndef ALGLINEINDEX_H
+#define ALGLINEINDEX_H
+
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QByteArray>
+#include <QVector>
+
+namespace Alg
+{
+    class LineIndex
+    {
+        // maps byte offsets in a utf-8 source to the line and column numbers the lexer reports;
+        // built once per source, each lookup is a binary search over the line starts
+    public:
+        LineIndex() {}
+        explicit LineIndex( const QByteArray& utf8 ) { build(utf8); }
+        void build( const QByteArray& utf8 );
+        bool isEmpty() const { return d_starts.isEmpty(); }
+
+        quint32 lineCount() const { return d_starts.size(); }
+        quint32 lineStart( quint32 line ) const; // offset of the 1-based line
+        quint32 line( quint32 offset ) const; // 1-based
+        quint32 column( quint32 offset ) const; // 1-based, in utf-16 units, ignoring underlines
+        void position( quint32 offset, quint32* line, quint32* col ) const;
+        static inline quint32 utf16Len( const char* str, int len ) // ignoring underlines
+        {
+            // QString compatible length, also used by the lexer for the columns and lengths of tokens
+            quint32 n = 0;
+            const uchar* s = (const uchar*)str;
+            for( int i = 0; i < len; i++ )
+            {
+                if( s[i] == 0xcc && i + 1 < len && s[i+1] == 0xb2 )
+                {
+                    i++;
+                    continue;
+                }
+                if( ( s[i] & 0xc0 ) != 0x80 )
+                    n++;
+                if( s[i] >= 0xf0 )
+                    n++; // surrogate pair
+            }
+            return n;
+        }
+    private:
+        QByteArray d_buf;
+        QVector<quint32> d_starts; // byte offset of each line start
+    };
+}
+
+#endif // ALGLINEINDEX_H
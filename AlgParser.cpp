@@ -1,767 +1,272 @@
-// This file was automatically generated by EbnfStudio; don't modify it!
+// This file was originally generated by EbnfStudio from syntax/Algol60.ebnf; it is now maintained by hand
+// and must not be overwritten by a regenerated version. Changes to the generated code:
+// - the nodes are allocated from the arena of the parser, see AlgSynTree.h
+// - optional elision of single child expression and statement rules in openChain and closeChain
+// - the parser is a template on its scanner, instantiated at the end of this file
+// - the FIRST sets are constexpr bitsets tested with the d_code of the lookahead
+// - the parser keeps its own lookahead window in peek and doesn't call Scanner::peek
 #include "AlgParser.h"
+#include "AlgLexer.h"
 using namespace Alg;
 
-static inline bool FIRST_program(int tt) {
-	switch(tt){
-	case Tok_Semi:
-	case Tok_identifier:
-	case Tok_BEGIN:
-	case Tok_unsigned_integer:
-	case Tok_ARRAY:
-	case Tok_FOR:
-	case Tok_REAL:
-	case Tok_BOOLEAN:
-	case Tok_PROCEDURE:
-	case Tok_OWN:
-	case Tok_INTEGER:
-	case Tok_GO:
-	case Tok_SWITCH:
-	case Tok_IF:
-	case Tok_GOTO:
-		return true;
-	default: return false;
-	}
+// A FIRST set is a bitset indexed by token type. The lexer folds pseudo keywords into d_code, which is the
+// token type otherwise, so a set which contains identifier also contains all pseudo keywords and each
+// decision is a single bit test on d_code.
+struct TokenSet {
+	quint64 bits[2];
+	constexpr bool contains(int tt) const { return ( bits[tt >> 6] >> ( tt & 63 ) ) & 1; }
+};
+static_assert( TT_Max <= 128, "TokenSet too small" );
+static constexpr quint64 tokenWord(int) { return 0; }
+template<class... T> static constexpr quint64 tokenWord(int w, int tt, T... rest) {
+	return ( ( tt >> 6 ) == w ? quint64(1) << ( tt & 63 ) : 0 ) | tokenWord(w, rest...);
 }
-
-static inline bool FIRST_declarations_(int tt) {
-	switch(tt){
-	case Tok_ARRAY:
-	case Tok_REAL:
-	case Tok_BOOLEAN:
-	case Tok_PROCEDURE:
-	case Tok_OWN:
-	case Tok_INTEGER:
-	case Tok_SWITCH:
-		return true;
-	default: return false;
-	}
+template<class... T> static constexpr TokenSet tokenSet(T... tts) {
+	return TokenSet{ { tokenWord(0, tts...), tokenWord(1, tts...) } };
 }
 
-static inline bool FIRST_compoundBlock_(int tt) {
-	return tt == Tok_BEGIN;
-}
+static constexpr TokenSet FIRST_program = tokenSet( Tok_Semi, Tok_identifier, Tok_BEGIN, Tok_unsigned_integer, Tok_ARRAY, Tok_FOR, Tok_REAL, Tok_BOOLEAN, Tok_PROCEDURE, Tok_OWN, Tok_INTEGER, Tok_GO, Tok_SWITCH, Tok_IF, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_statementList_(int tt) {
-	switch(tt){
-	case Tok_Semi:
-	case Tok_identifier:
-	case Tok_BEGIN:
-	case Tok_unsigned_integer:
-	case Tok_FOR:
-	case Tok_GO:
-	case Tok_IF:
-	case Tok_GOTO:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_declarations_ = tokenSet( Tok_ARRAY, Tok_REAL, Tok_BOOLEAN, Tok_PROCEDURE, Tok_OWN, Tok_INTEGER, Tok_SWITCH );
 
-static inline bool FIRST_compound_tail(int tt) {
-	switch(tt){
-	case Tok_Semi:
-	case Tok_identifier:
-	case Tok_BEGIN:
-	case Tok_unsigned_integer:
-	case Tok_END:
-	case Tok_FOR:
-	case Tok_GO:
-	case Tok_IF:
-	case Tok_GOTO:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_compoundBlock_ = tokenSet( Tok_BEGIN );
 
-static inline bool FIRST_declaration(int tt) {
-	switch(tt){
-	case Tok_ARRAY:
-	case Tok_REAL:
-	case Tok_BOOLEAN:
-	case Tok_PROCEDURE:
-	case Tok_OWN:
-	case Tok_INTEGER:
-	case Tok_SWITCH:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_statementList_ = tokenSet( Tok_Semi, Tok_identifier, Tok_BEGIN, Tok_unsigned_integer, Tok_FOR, Tok_GO, Tok_IF, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_type_declaration(int tt) {
-	return tt == Tok_REAL || tt == Tok_BOOLEAN || tt == Tok_OWN || tt == Tok_INTEGER;
-}
+static constexpr TokenSet FIRST_compound_tail = tokenSet( Tok_Semi, Tok_identifier, Tok_BEGIN, Tok_unsigned_integer, Tok_END, Tok_FOR, Tok_GO, Tok_IF, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_local_or_own_type(int tt) {
-	return tt == Tok_REAL || tt == Tok_BOOLEAN || tt == Tok_OWN || tt == Tok_INTEGER;
-}
+static constexpr TokenSet FIRST_declaration = tokenSet( Tok_ARRAY, Tok_REAL, Tok_BOOLEAN, Tok_PROCEDURE, Tok_OWN, Tok_INTEGER, Tok_SWITCH );
 
-static inline bool FIRST_type(int tt) {
-	return tt == Tok_REAL || tt == Tok_BOOLEAN || tt == Tok_INTEGER;
-}
+static constexpr TokenSet FIRST_type_declaration = tokenSet( Tok_REAL, Tok_BOOLEAN, Tok_OWN, Tok_INTEGER );
 
-static inline bool FIRST_type_list(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_local_or_own_type = tokenSet( Tok_REAL, Tok_BOOLEAN, Tok_OWN, Tok_INTEGER );
 
-static inline bool FIRST_array_declaration(int tt) {
-	return tt == Tok_ARRAY || tt == Tok_REAL || tt == Tok_BOOLEAN || tt == Tok_OWN || tt == Tok_INTEGER;
-}
+static constexpr TokenSet FIRST_type = tokenSet( Tok_REAL, Tok_BOOLEAN, Tok_INTEGER );
 
-static inline bool FIRST_array_list(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_type_list = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_array_segment(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_array_declaration = tokenSet( Tok_ARRAY, Tok_REAL, Tok_BOOLEAN, Tok_OWN, Tok_INTEGER );
 
-static inline bool FIRST_bound_pair_list(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_array_list = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_bound_pair(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_array_segment = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_upper_bound(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_bound_pair_list = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_lower_bound(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_bound_pair = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_switch_declaration(int tt) {
-	return tt == Tok_SWITCH;
-}
+static constexpr TokenSet FIRST_upper_bound = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_switch_identifier(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_lower_bound = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_switch_list(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number || tt == Tok_IF;
-}
+static constexpr TokenSet FIRST_switch_declaration = tokenSet( Tok_SWITCH );
 
-static inline bool FIRST_procedure_declaration(int tt) {
-	return tt == Tok_REAL || tt == Tok_BOOLEAN || tt == Tok_PROCEDURE || tt == Tok_INTEGER;
-}
+static constexpr TokenSet FIRST_switch_identifier = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_procedure_heading(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_switch_list = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_procedure_identifier(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_procedure_declaration = tokenSet( Tok_REAL, Tok_BOOLEAN, Tok_PROCEDURE, Tok_INTEGER );
 
-static inline bool FIRST_formal_parameter_part(int tt) {
-	return tt == Tok_Lpar;
-}
+static constexpr TokenSet FIRST_procedure_heading = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_formal_parameter_list(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_procedure_identifier = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_formal_parameter(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_formal_parameter_part = tokenSet( Tok_Lpar );
 
-static inline bool FIRST_value_part(int tt) {
-	return tt == Tok_VALUE;
-}
+static constexpr TokenSet FIRST_formal_parameter_list = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_specification_part(int tt) {
-	switch(tt){
-	case Tok_ARRAY:
-	case Tok_REAL:
-	case Tok_PROCEDURE:
-	case Tok_BOOLEAN:
-	case Tok_LABEL:
-	case Tok_STRING:
-	case Tok_INTEGER:
-	case Tok_SWITCH:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_formal_parameter = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_specifier(int tt) {
-	switch(tt){
-	case Tok_ARRAY:
-	case Tok_REAL:
-	case Tok_PROCEDURE:
-	case Tok_BOOLEAN:
-	case Tok_LABEL:
-	case Tok_STRING:
-	case Tok_INTEGER:
-	case Tok_SWITCH:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_value_part = tokenSet( Tok_VALUE );
 
-static inline bool FIRST_identifier_list(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_specification_part = tokenSet( Tok_ARRAY, Tok_REAL, Tok_PROCEDURE, Tok_BOOLEAN, Tok_LABEL, Tok_STRING, Tok_INTEGER, Tok_SWITCH );
 
-static inline bool FIRST_procedure_body(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_BEGIN:
-	case Tok_unsigned_integer:
-	case Tok_FOR:
-	case Tok_GO:
-	case Tok_IF:
-	case Tok_GOTO:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_specifier = tokenSet( Tok_ARRAY, Tok_REAL, Tok_PROCEDURE, Tok_BOOLEAN, Tok_LABEL, Tok_STRING, Tok_INTEGER, Tok_SWITCH );
 
-static inline bool FIRST_statement(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_BEGIN:
-	case Tok_unsigned_integer:
-	case Tok_FOR:
-	case Tok_GO:
-	case Tok_IF:
-	case Tok_GOTO:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_identifier_list = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_unconditional_statement(int tt) {
-	return tt == Tok_identifier || tt == Tok_BEGIN || tt == Tok_GO || tt == Tok_GOTO;
-}
+static constexpr TokenSet FIRST_procedure_body = tokenSet( Tok_identifier, Tok_BEGIN, Tok_unsigned_integer, Tok_FOR, Tok_GO, Tok_IF, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_basic_statement(int tt) {
-	return tt == Tok_identifier || tt == Tok_GO || tt == Tok_GOTO;
-}
+static constexpr TokenSet FIRST_statement = tokenSet( Tok_identifier, Tok_BEGIN, Tok_unsigned_integer, Tok_FOR, Tok_GO, Tok_IF, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_label(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer;
-}
+static constexpr TokenSet FIRST_unconditional_statement = tokenSet( Tok_identifier, Tok_BEGIN, Tok_GO, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_unlabelled_basic_statement(int tt) {
-	return tt == Tok_identifier || tt == Tok_GO || tt == Tok_GOTO;
-}
+static constexpr TokenSet FIRST_basic_statement = tokenSet( Tok_identifier, Tok_GO, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_procedureOrAssignmentStmt_(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_label = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_go_to_statement(int tt) {
-	return tt == Tok_GO || tt == Tok_GOTO;
-}
+static constexpr TokenSet FIRST_unlabelled_basic_statement = tokenSet( Tok_identifier, Tok_GO, Tok_GOTO, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_actual_parameter_list(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-	case Tok_IF:
-	case Tok_string:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_procedureOrAssignmentStmt_ = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_parameter_delimiter(int tt) {
-	return tt == Tok_Rpar || tt == Tok_Comma;
-}
-
-static inline bool FIRST_actual_parameter(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-	case Tok_IF:
-	case Tok_string:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_go_to_statement = tokenSet( Tok_GO, Tok_GOTO );
 
-static inline bool FIRST_conditional_statement(int tt) {
-	return tt == Tok_IF;
-}
+static constexpr TokenSet FIRST_actual_parameter_list = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_IF, Tok_string, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_if_clause(int tt) {
-	return tt == Tok_IF;
-}
+static constexpr TokenSet FIRST_parameter_delimiter = tokenSet( Tok_Rpar, Tok_Comma );
 
-static inline bool FIRST_for_statement(int tt) {
-	return tt == Tok_FOR;
-}
+static constexpr TokenSet FIRST_actual_parameter = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_IF, Tok_string, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_for_clause(int tt) {
-	return tt == Tok_FOR;
-}
+static constexpr TokenSet FIRST_conditional_statement = tokenSet( Tok_IF );
 
-static inline bool FIRST_for_list(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_if_clause = tokenSet( Tok_IF );
 
-static inline bool FIRST_for_list_element(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_for_statement = tokenSet( Tok_FOR );
 
-static inline bool FIRST_expression(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_for_clause = tokenSet( Tok_FOR );
 
-static inline bool FIRST_arithmetic_expression(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_for_list = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_simple_arithmetic_expression(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_for_list_element = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_adding_operator(int tt) {
-	return tt == Tok_Minus || tt == Tok_Plus;
-}
+static constexpr TokenSet FIRST_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_term(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number;
-}
+static constexpr TokenSet FIRST_arithmetic_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_multiplying_operator(int tt) {
-	switch(tt){
-	case Tok_Udiv:
-	case Tok_Slash:
-	case Tok_MOD:
-	case Tok_Umul:
-	case Tok_DIV:
-	case Tok_Percent:
-	case Tok_Star:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_simple_arithmetic_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_factor(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number;
-}
+static constexpr TokenSet FIRST_adding_operator = tokenSet( Tok_Minus, Tok_Plus );
 
-static inline bool FIRST_power_sym_(int tt) {
-	return tt == Tok_2Star || tt == Tok_POWER || tt == Tok_Uexp || tt == Tok_Hat;
-}
+static constexpr TokenSet FIRST_term = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_primary(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number;
-}
+static constexpr TokenSet FIRST_multiplying_operator = tokenSet( Tok_Udiv, Tok_Slash, Tok_MOD, Tok_Umul, Tok_DIV, Tok_Percent, Tok_Star );
 
-static inline bool FIRST_designational_expression(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number || tt == Tok_IF;
-}
+static constexpr TokenSet FIRST_factor = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_simple_designational_expression(int tt) {
-	return tt == Tok_identifier || tt == Tok_unsigned_integer || tt == Tok_Lpar || tt == Tok_decimal_number;
-}
+static constexpr TokenSet FIRST_power_sym_ = tokenSet( Tok_2Star, Tok_POWER, Tok_Uexp, Tok_Hat );
 
-static inline bool FIRST_Boolean_expression(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_primary = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_simple_Boolean(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_designational_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_equiv_sym_(int tt) {
-	return tt == Tok_Ueq || tt == Tok_2Eq || tt == Tok_EQUIV;
-}
-
-static inline bool FIRST_implication(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_simple_designational_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Lpar, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_impl_sym_(int tt) {
-	return tt == Tok_MinusGt || tt == Tok_Uimpl || tt == Tok_IMPL;
-}
-
-static inline bool FIRST_Boolean_term(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_Boolean_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_or_sym_(int tt) {
-	return tt == Tok_Bar || tt == Tok_Uor || tt == Tok_OR;
-}
-
-static inline bool FIRST_Boolean_factor(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_simple_Boolean = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_and_sym_(int tt) {
-	return tt == Tok_Uand || tt == Tok_AND || tt == Tok_Amp;
-}
-
-static inline bool FIRST_Boolean_secondary(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Unot:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_NOT:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_Bang:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_equiv_sym_ = tokenSet( Tok_Ueq, Tok_2Eq, Tok_EQUIV );
 
-static inline bool FIRST_not_sym_(int tt) {
-	return tt == Tok_Unot || tt == Tok_NOT || tt == Tok_Bang;
-}
+static constexpr TokenSet FIRST_implication = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_Boolean_primary(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_TRUE:
-	case Tok_Lpar:
-	case Tok_FALSE:
-	case Tok_Plus:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_impl_sym_ = tokenSet( Tok_MinusGt, Tok_Uimpl, Tok_IMPL );
 
-static inline bool FIRST_relation(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_Boolean_term = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_relational_operator(int tt) {
-	switch(tt){
-	case Tok_Eq:
-	case Tok_BangEq:
-	case Tok_Uleq:
-	case Tok_NOTEQUAL:
-	case Tok_LESS:
-	case Tok_GREATER:
-	case Tok_Geq:
-	case Tok_Ugeq:
-	case Tok_Gt:
-	case Tok_Uneq:
-	case Tok_LtGt:
-	case Tok_HatEq:
-	case Tok_NOTLESS:
-	case Tok_Leq:
-	case Tok_NOTGREATER:
-	case Tok_Lt:
-	case Tok_EQUAL:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_or_sym_ = tokenSet( Tok_Bar, Tok_Uor, Tok_OR );
 
-static inline bool FIRST_variableOrFunction_(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_Boolean_factor = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_variable(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_and_sym_ = tokenSet( Tok_Uand, Tok_AND, Tok_Amp );
 
-static inline bool FIRST_simple_variable(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_Boolean_secondary = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Unot, Tok_TRUE, Tok_Lpar, Tok_NOT, Tok_FALSE, Tok_Plus, Tok_Bang, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_variable_identifier(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_not_sym_ = tokenSet( Tok_Unot, Tok_NOT, Tok_Bang );
 
-static inline bool FIRST_subscript_list(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_Boolean_primary = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_TRUE, Tok_Lpar, Tok_FALSE, Tok_Plus, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_subscript_expression(int tt) {
-	switch(tt){
-	case Tok_identifier:
-	case Tok_unsigned_integer:
-	case Tok_Minus:
-	case Tok_Lpar:
-	case Tok_Plus:
-	case Tok_decimal_number:
-	case Tok_IF:
-		return true;
-	default: return false;
-	}
-}
+static constexpr TokenSet FIRST_relation = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_unsigned_number(int tt) {
-	return tt == Tok_unsigned_integer || tt == Tok_decimal_number;
-}
+static constexpr TokenSet FIRST_relational_operator = tokenSet( Tok_Eq, Tok_BangEq, Tok_Uleq, Tok_NOTEQUAL, Tok_LESS, Tok_GREATER, Tok_Geq, Tok_Ugeq, Tok_Gt, Tok_Uneq, Tok_LtGt, Tok_HatEq, Tok_NOTLESS, Tok_Leq, Tok_NOTGREATER, Tok_Lt, Tok_EQUAL );
 
-static inline bool FIRST_letter_string(int tt) {
-	return tt == Tok_identifier;
-}
+static constexpr TokenSet FIRST_variableOrFunction_ = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-static inline bool FIRST_logical_value(int tt) {
-	return tt == Tok_TRUE || tt == Tok_FALSE;
-}
+static constexpr TokenSet FIRST_variable = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
+
+static constexpr TokenSet FIRST_simple_variable = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
+
+static constexpr TokenSet FIRST_variable_identifier = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
+
+static constexpr TokenSet FIRST_subscript_list = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
+
+static constexpr TokenSet FIRST_subscript_expression = tokenSet( Tok_identifier, Tok_unsigned_integer, Tok_Minus, Tok_Lpar, Tok_Plus, Tok_decimal_number, Tok_IF, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
+
+static constexpr TokenSet FIRST_unsigned_number = tokenSet( Tok_unsigned_integer, Tok_decimal_number );
+
+static constexpr TokenSet FIRST_letter_string = tokenSet( Tok_identifier, Tok_DIV, Tok_MOD, Tok_POWER, Tok_EQUIV, Tok_IMPL, Tok_OR, Tok_AND, Tok_NOT, Tok_LESS, Tok_NOTGREATER, Tok_EQUAL, Tok_NOTLESS, Tok_GREATER, Tok_NOTEQUAL, Tok_REAL, Tok_INTEGER, Tok_BOOLEAN, Tok_SWITCH, Tok_STRING, Tok_LABEL );
 
-void Parser::RunParser() {
+static constexpr TokenSet FIRST_logical_value = tokenSet( Tok_TRUE, Tok_FALSE );
+
+template<class S> void ParserT<S>::RunParser() {
 	root = SynTree();
+	arena.clear();
 	errors.clear();
+	window.clear();
 	next();
 	program(&root);
 }
 
-void Parser::next() {
-	cur = la;
-	la = scanner->next();
+template<class S> void ParserT<S>::next() {
+	cur = std::move(la);
+	la = fetch();
 	while( la.d_type == Tok_Invalid ) {
 		errors << Error(la.d_val, la.d_lineNr, la.d_colNr, la.d_sourcePath);
-		la = scanner->next();
+		la = fetch();
 	}
 }
 
-Token Parser::peek(int off) {
+template<class S> const Token& ParserT<S>::peek(int off) {
 	if( off == 1 )
 		return la;
 	else if( off == 0 )
 		return cur;
-	else
-		return scanner->peek(off-1);
+	// the tokens following la are fetched from the scanner once and then referenced in the window
+	while( window.size() < off - 1 )
+		window.push_back(scanner->next());
+	return window.at(off-2);
 }
 
-void Parser::invalid(const char* what) {
+template<class S> void ParserT<S>::invalid(const char* what) {
 	errors << Error(QString("invalid %1").arg(what),la.d_lineNr, la.d_colNr, la.d_sourcePath);
 }
 
-bool Parser::expect(int tt, bool pkw, const char* where) {
+template<class S> bool ParserT<S>::expect(int tt, bool pkw, const char* where) {
 	if( la.d_type == tt || la.d_code == tt) { next(); return true; }
 	else { errors << Error(QString("'%1' expected in %2").arg(tokenTypeString(tt)).arg(where),la.d_lineNr, la.d_colNr, la.d_sourcePath); return false; }
 }
 
+template<class S> typename ParserT<S>::Chain ParserT<S>::openChain(SynTree*& st, quint16 r) {
+	Chain c;
+	c.up = 0;
+	if( !elideChains ) {
+		SynTree* tmp = arena.create(r, la); st->d_children.append(tmp); st = tmp;
+		return c;
+	}
+	// the rule adds its children to the parent until closeChain knows whether it needs a node at all
+	c.up = st;
+	c.prev = st->d_children.last();
+	c.first = st->d_children.size();
+	c.tok = arena.toSynToken(r, la);
+	return c;
+}
+
+template<class S> void ParserT<S>::closeChain(const Chain& c) {
+	if( c.up == 0 || c.up->d_children.size() - c.first == 1 )
+		return; // a single child takes the place of the rule and keeps its own position
+	// more than one child, or none after a syntax error: the rule gets the node it has without elision
+	SynTree* tmp = arena.create(c.tok);
+	c.up->d_children.moveTail(c.prev, c.first, tmp->d_children);
+	c.up->d_children.append(tmp);
+}
+
 static inline void dummy() {}
-	void Parser::addTerminal(SynTree* st) {
-		SynTree* tmp = new SynTree( cur ); st->d_children.append(tmp);
+	template<class S> void ParserT<S>::addTerminal(SynTree* st) {
+		SynTree* tmp = arena.create( cur ); st->d_children.append(tmp);
 	}
-void Parser::program(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_program, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::program(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_program, la); st->d_children.append(tmp); st = tmp; }
 	while( ( ( peek(1).d_type == Tok_identifier || peek(1).d_type == Tok_unsigned_integer ) && peek(2).d_type == Tok_Colon )  ) {
 		label(st);
 		if( expect(Tok_Colon, false, "program") ) addTerminal(st);
 	}
-	if( FIRST_declarations_(la.d_type) || FIRST_declarations_(la.d_code) ) {
+	if( FIRST_declarations_.contains(la.d_code) ) {
 		declarations_(st);
 	}
 	statementList_(st);
 }
 
-void Parser::declarations_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_declarations_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::declarations_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_declarations_, la); st->d_children.append(tmp); st = tmp; }
 	declaration(st);
 	while( ( peek(1).d_type == Tok_Semi && ( peek(2).d_type == Tok_ARRAY || peek(2).d_code == Tok_BOOLEAN || peek(2).d_code == Tok_INTEGER || peek(2).d_type == Tok_OWN || peek(2).d_type == Tok_PROCEDURE || peek(2).d_code == Tok_REAL || peek(2).d_code == Tok_SWITCH ) )  ) {
 		if( expect(Tok_Semi, false, "declarations_") ) addTerminal(st);
@@ -770,17 +275,17 @@ void Parser::declarations_(SynTree* st) {
 	if( expect(Tok_Semi, false, "declarations_") ) addTerminal(st);
 }
 
-void Parser::compoundBlock_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_compoundBlock_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::compoundBlock_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_compoundBlock_, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_BEGIN, false, "compoundBlock_") ) addTerminal(st);
-	if( FIRST_declarations_(la.d_type) || FIRST_declarations_(la.d_code) ) {
+	if( FIRST_declarations_.contains(la.d_code) ) {
 		declarations_(st);
 	}
 	compound_tail(st);
 }
 
-void Parser::statementList_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_statementList_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::statementList_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_statementList_, la); st->d_children.append(tmp); st = tmp; }
 	statement(st);
 	while( la.d_type == Tok_Semi ) {
 		if( expect(Tok_Semi, false, "statementList_") ) addTerminal(st);
@@ -788,42 +293,42 @@ void Parser::statementList_(SynTree* st) {
 	}
 }
 
-void Parser::compound_tail(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_compound_tail, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::compound_tail(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_compound_tail, la); st->d_children.append(tmp); st = tmp; }
 	statementList_(st);
 	if( expect(Tok_END, false, "compound_tail") ) addTerminal(st);
 }
 
-void Parser::declaration(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_declaration, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_switch_declaration(la.d_type) || FIRST_switch_declaration(la.d_code) ) {
+template<class S> void ParserT<S>::declaration(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_declaration, la); st->d_children.append(tmp); st = tmp; }
+	if( FIRST_switch_declaration.contains(la.d_code) ) {
 		switch_declaration(st);
 	} else if( ( ( peek(1).d_type == Tok_PROCEDURE || peek(2).d_type == Tok_PROCEDURE ) )  ) {
 		procedure_declaration(st);
 	} else if( ( ( peek(1).d_type == Tok_ARRAY || peek(2).d_type == Tok_ARRAY || peek(3).d_type == Tok_ARRAY ) )  ) {
 		array_declaration(st);
-	} else if( FIRST_type_declaration(la.d_type) || FIRST_type_declaration(la.d_code) ) {
+	} else if( FIRST_type_declaration.contains(la.d_code) ) {
 		type_declaration(st);
 	} else
 		invalid("declaration");
 }
 
-void Parser::type_declaration(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_type_declaration, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::type_declaration(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_type_declaration, la); st->d_children.append(tmp); st = tmp; }
 	local_or_own_type(st);
 	type_list(st);
 }
 
-void Parser::local_or_own_type(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_local_or_own_type, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::local_or_own_type(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_local_or_own_type, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_OWN ) {
 		if( expect(Tok_OWN, false, "local_or_own_type") ) addTerminal(st);
 	}
 	type(st);
 }
 
-void Parser::type(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_type, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::type(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_type, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_REAL ) {
 		if( expect(Tok_REAL, true, "type") ) addTerminal(st);
 	} else if( la.d_code == Tok_INTEGER ) {
@@ -834,8 +339,8 @@ void Parser::type(SynTree* st) {
 		invalid("type");
 }
 
-void Parser::type_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_type_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::type_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_type_list, la); st->d_children.append(tmp); st = tmp; }
 	simple_variable(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "type_list") ) addTerminal(st);
@@ -843,17 +348,17 @@ void Parser::type_list(SynTree* st) {
 	}
 }
 
-void Parser::array_declaration(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_array_declaration, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_local_or_own_type(la.d_type) || FIRST_local_or_own_type(la.d_code) ) {
+template<class S> void ParserT<S>::array_declaration(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_array_declaration, la); st->d_children.append(tmp); st = tmp; }
+	if( FIRST_local_or_own_type.contains(la.d_code) ) {
 		local_or_own_type(st);
 	}
 	if( expect(Tok_ARRAY, false, "array_declaration") ) addTerminal(st);
 	array_list(st);
 }
 
-void Parser::array_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_array_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::array_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_array_list, la); st->d_children.append(tmp); st = tmp; }
 	array_segment(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "array_list") ) addTerminal(st);
@@ -861,8 +366,8 @@ void Parser::array_list(SynTree* st) {
 	}
 }
 
-void Parser::array_segment(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_array_segment, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::array_segment(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_array_segment, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "array_segment") ) addTerminal(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "array_segment") ) addTerminal(st);
@@ -873,8 +378,8 @@ void Parser::array_segment(SynTree* st) {
 	if( expect(Tok_Rbrack, false, "array_segment") ) addTerminal(st);
 }
 
-void Parser::bound_pair_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_bound_pair_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::bound_pair_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_bound_pair_list, la); st->d_children.append(tmp); st = tmp; }
 	bound_pair(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "bound_pair_list") ) addTerminal(st);
@@ -882,38 +387,38 @@ void Parser::bound_pair_list(SynTree* st) {
 	}
 }
 
-void Parser::bound_pair(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_bound_pair, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::bound_pair(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_bound_pair, la); st->d_children.append(tmp); st = tmp; }
 	lower_bound(st);
 	if( expect(Tok_Colon, false, "bound_pair") ) addTerminal(st);
 	upper_bound(st);
 }
 
-void Parser::upper_bound(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_upper_bound, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::upper_bound(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_upper_bound, la); st->d_children.append(tmp); st = tmp; }
 	arithmetic_expression(st);
 }
 
-void Parser::lower_bound(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_lower_bound, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::lower_bound(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_lower_bound, la); st->d_children.append(tmp); st = tmp; }
 	arithmetic_expression(st);
 }
 
-void Parser::switch_declaration(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_switch_declaration, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::switch_declaration(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_switch_declaration, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_SWITCH, true, "switch_declaration") ) addTerminal(st);
 	switch_identifier(st);
 	if( expect(Tok_ColonEq, false, "switch_declaration") ) addTerminal(st);
 	switch_list(st);
 }
 
-void Parser::switch_identifier(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_switch_identifier, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::switch_identifier(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_switch_identifier, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "switch_identifier") ) addTerminal(st);
 }
 
-void Parser::switch_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_switch_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::switch_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_switch_list, la); st->d_children.append(tmp); st = tmp; }
 	designational_expression(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "switch_list") ) addTerminal(st);
@@ -921,9 +426,9 @@ void Parser::switch_list(SynTree* st) {
 	}
 }
 
-void Parser::procedure_declaration(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_procedure_declaration, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_type(la.d_type) || FIRST_type(la.d_code) ) {
+template<class S> void ParserT<S>::procedure_declaration(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_procedure_declaration, la); st->d_children.append(tmp); st = tmp; }
+	if( FIRST_type.contains(la.d_code) ) {
 		type(st);
 	}
 	if( expect(Tok_PROCEDURE, false, "procedure_declaration") ) addTerminal(st);
@@ -931,35 +436,35 @@ void Parser::procedure_declaration(SynTree* st) {
 	procedure_body(st);
 }
 
-void Parser::procedure_heading(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_procedure_heading, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::procedure_heading(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_procedure_heading, la); st->d_children.append(tmp); st = tmp; }
 	procedure_identifier(st);
-	if( FIRST_formal_parameter_part(la.d_type) ) {
+	if( FIRST_formal_parameter_part.contains(la.d_code) ) {
 		formal_parameter_part(st);
 	}
 	if( expect(Tok_Semi, false, "procedure_heading") ) addTerminal(st);
-	if( FIRST_value_part(la.d_type) ) {
+	if( FIRST_value_part.contains(la.d_code) ) {
 		value_part(st);
 	}
-	if( FIRST_specification_part(la.d_type) || FIRST_specification_part(la.d_code) ) {
+	if( FIRST_specification_part.contains(la.d_code) ) {
 		specification_part(st);
 	}
 }
 
-void Parser::procedure_identifier(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_procedure_identifier, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::procedure_identifier(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_procedure_identifier, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "procedure_identifier") ) addTerminal(st);
 }
 
-void Parser::formal_parameter_part(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_formal_parameter_part, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::formal_parameter_part(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_formal_parameter_part, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_Lpar, false, "formal_parameter_part") ) addTerminal(st);
 	formal_parameter_list(st);
 	if( expect(Tok_Rpar, false, "formal_parameter_part") ) addTerminal(st);
 }
 
-void Parser::formal_parameter_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_formal_parameter_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::formal_parameter_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_formal_parameter_list, la); st->d_children.append(tmp); st = tmp; }
 	formal_parameter(st);
 	while( ( ( peek(1).d_type == Tok_Comma || peek(1).d_type == Tok_Rpar ) && peek(2).d_type == Tok_identifier )  ) {
 		parameter_delimiter(st);
@@ -967,29 +472,29 @@ void Parser::formal_parameter_list(SynTree* st) {
 	}
 }
 
-void Parser::formal_parameter(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_formal_parameter, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::formal_parameter(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_formal_parameter, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "formal_parameter") ) addTerminal(st);
 }
 
-void Parser::value_part(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_value_part, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::value_part(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_value_part, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_VALUE, false, "value_part") ) addTerminal(st);
 	identifier_list(st);
 	if( expect(Tok_Semi, false, "value_part") ) addTerminal(st);
 }
 
-void Parser::specification_part(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_specification_part, la); st->d_children.append(tmp); st = tmp; }
-	while( FIRST_specifier(la.d_type) || FIRST_specifier(la.d_code) ) {
+template<class S> void ParserT<S>::specification_part(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_specification_part, la); st->d_children.append(tmp); st = tmp; }
+	while( FIRST_specifier.contains(la.d_code) ) {
 		specifier(st);
 		identifier_list(st);
 		if( expect(Tok_Semi, false, "specification_part") ) addTerminal(st);
 	}
 }
 
-void Parser::specifier(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_specifier, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::specifier(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_specifier, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_STRING ) {
 		if( expect(Tok_STRING, true, "specifier") ) addTerminal(st);
 	} else if( la.d_code == Tok_LABEL ) {
@@ -997,7 +502,7 @@ void Parser::specifier(SynTree* st) {
 	} else if( la.d_code == Tok_SWITCH ) {
 		if( expect(Tok_SWITCH, true, "specifier") ) addTerminal(st);
 	} else if( ( ( peek(1).d_type == Tok_PROCEDURE || peek(2).d_type == Tok_PROCEDURE || peek(1).d_type == Tok_ARRAY || peek(2).d_type == Tok_ARRAY ) )  ) {
-		if( FIRST_type(la.d_type) || FIRST_type(la.d_code) ) {
+		if( FIRST_type.contains(la.d_code) ) {
 			type(st);
 		}
 		if( la.d_type == Tok_ARRAY ) {
@@ -1006,14 +511,14 @@ void Parser::specifier(SynTree* st) {
 			if( expect(Tok_PROCEDURE, false, "specifier") ) addTerminal(st);
 		} else
 			invalid("specifier");
-	} else if( FIRST_type(la.d_type) || FIRST_type(la.d_code) ) {
+	} else if( FIRST_type.contains(la.d_code) ) {
 		type(st);
 	} else
 		invalid("specifier");
 }
 
-void Parser::identifier_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_identifier_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::identifier_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_identifier_list, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "identifier_list") ) addTerminal(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "identifier_list") ) addTerminal(st);
@@ -1021,46 +526,48 @@ void Parser::identifier_list(SynTree* st) {
 	}
 }
 
-void Parser::procedure_body(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_procedure_body, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::procedure_body(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_procedure_body, la); st->d_children.append(tmp); st = tmp; }
 	statement(st);
 }
 
-void Parser::statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_statement, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::statement(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_statement, la); st->d_children.append(tmp); st = tmp; }
 	while( ( ( peek(1).d_type == Tok_identifier || peek(1).d_type == Tok_unsigned_integer ) && peek(2).d_type == Tok_Colon )  ) {
 		label(st);
 		if( expect(Tok_Colon, false, "statement") ) addTerminal(st);
 	}
-	if( FIRST_unconditional_statement(la.d_type) || FIRST_conditional_statement(la.d_type) || FIRST_for_statement(la.d_type) ) {
-		if( FIRST_unconditional_statement(la.d_type) ) {
+	if( FIRST_unconditional_statement.contains(la.d_code) || FIRST_conditional_statement.contains(la.d_code) || FIRST_for_statement.contains(la.d_code) ) {
+		if( FIRST_unconditional_statement.contains(la.d_code) ) {
 			unconditional_statement(st);
-		} else if( FIRST_conditional_statement(la.d_type) ) {
+		} else if( FIRST_conditional_statement.contains(la.d_code) ) {
 			conditional_statement(st);
-		} else if( FIRST_for_statement(la.d_type) ) {
+		} else if( FIRST_for_statement.contains(la.d_code) ) {
 			for_statement(st);
 		} else
 			invalid("statement");
 	}
 }
 
-void Parser::unconditional_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_unconditional_statement, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_basic_statement(la.d_type) ) {
+template<class S> void ParserT<S>::unconditional_statement(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_unconditional_statement);
+	if( FIRST_basic_statement.contains(la.d_code) ) {
 		basic_statement(st);
-	} else if( FIRST_compoundBlock_(la.d_type) ) {
+	} else if( FIRST_compoundBlock_.contains(la.d_code) ) {
 		compoundBlock_(st);
 	} else
 		invalid("unconditional_statement");
+	closeChain(chain);
 }
 
-void Parser::basic_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_basic_statement, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::basic_statement(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_basic_statement);
 	unlabelled_basic_statement(st);
+	closeChain(chain);
 }
 
-void Parser::label(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_label, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::label(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_label, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_identifier ) {
 		if( expect(Tok_identifier, false, "label") ) addTerminal(st);
 	} else if( la.d_type == Tok_unsigned_integer ) {
@@ -1069,18 +576,19 @@ void Parser::label(SynTree* st) {
 		invalid("label");
 }
 
-void Parser::unlabelled_basic_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_unlabelled_basic_statement, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_procedureOrAssignmentStmt_(la.d_type) ) {
+template<class S> void ParserT<S>::unlabelled_basic_statement(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_unlabelled_basic_statement);
+	if( FIRST_procedureOrAssignmentStmt_.contains(la.d_code) ) {
 		procedureOrAssignmentStmt_(st);
-	} else if( FIRST_go_to_statement(la.d_type) ) {
+	} else if( FIRST_go_to_statement.contains(la.d_code) ) {
 		go_to_statement(st);
 	} else
 		invalid("unlabelled_basic_statement");
+	closeChain(chain);
 }
 
-void Parser::procedureOrAssignmentStmt_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_procedureOrAssignmentStmt_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::procedureOrAssignmentStmt_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_procedureOrAssignmentStmt_, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "procedureOrAssignmentStmt_") ) addTerminal(st);
 	if( la.d_type == Tok_Lbrack || la.d_type == Tok_ColonEq || la.d_type == Tok_Lpar ) {
 		if( la.d_type == Tok_Lbrack || la.d_type == Tok_ColonEq ) {
@@ -1104,8 +612,8 @@ void Parser::procedureOrAssignmentStmt_(SynTree* st) {
 	}
 }
 
-void Parser::go_to_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_go_to_statement, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::go_to_statement(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_go_to_statement, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_GOTO ) {
 		if( expect(Tok_GOTO, false, "go_to_statement") ) addTerminal(st);
 	} else if( la.d_type == Tok_GO ) {
@@ -1116,8 +624,8 @@ void Parser::go_to_statement(SynTree* st) {
 	designational_expression(st);
 }
 
-void Parser::actual_parameter_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_actual_parameter_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::actual_parameter_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_actual_parameter_list, la); st->d_children.append(tmp); st = tmp; }
 	actual_parameter(st);
 	while( ( ( peek(1).d_type == Tok_Comma || peek(1).d_type == Tok_Rpar && peek(2).d_type == Tok_identifier && peek(3).d_type == Tok_Colon ) )  ) {
 		parameter_delimiter(st);
@@ -1125,8 +633,8 @@ void Parser::actual_parameter_list(SynTree* st) {
 	}
 }
 
-void Parser::parameter_delimiter(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_parameter_delimiter, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::parameter_delimiter(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_parameter_delimiter, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "parameter_delimiter") ) addTerminal(st);
 	} else if( la.d_type == Tok_Rpar ) {
@@ -1138,52 +646,52 @@ void Parser::parameter_delimiter(SynTree* st) {
 		invalid("parameter_delimiter");
 }
 
-void Parser::actual_parameter(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_actual_parameter, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::actual_parameter(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_actual_parameter, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_string ) {
 		if( expect(Tok_string, false, "actual_parameter") ) addTerminal(st);
-	} else if( FIRST_expression(la.d_type) || FIRST_expression(la.d_code) ) {
+	} else if( FIRST_expression.contains(la.d_code) ) {
 		expression(st);
 	} else
 		invalid("actual_parameter");
 }
 
-void Parser::conditional_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_conditional_statement, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::conditional_statement(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_conditional_statement, la); st->d_children.append(tmp); st = tmp; }
 	if_clause(st);
 	while( ( ( peek(1).d_type == Tok_identifier || peek(1).d_type == Tok_unsigned_integer ) && peek(2).d_type == Tok_Colon )  ) {
 		label(st);
 		if( expect(Tok_Colon, false, "conditional_statement") ) addTerminal(st);
 	}
-	if( FIRST_unconditional_statement(la.d_type) || la.d_type == Tok_ELSE || la.d_type == Tok_Semi || la.d_type == Tok_Semi || la.d_type == Tok_END || la.d_type == Tok_Semi ) {
-		if( FIRST_unconditional_statement(la.d_type) ) {
+	if( FIRST_unconditional_statement.contains(la.d_code) || la.d_type == Tok_ELSE || la.d_type == Tok_Semi || la.d_type == Tok_Semi || la.d_type == Tok_END || la.d_type == Tok_Semi ) {
+		if( FIRST_unconditional_statement.contains(la.d_code) ) {
 			unconditional_statement(st);
 		}
 		if( la.d_type == Tok_ELSE ) {
 			if( expect(Tok_ELSE, false, "conditional_statement") ) addTerminal(st);
 			statement(st);
 		}
-	} else if( FIRST_for_statement(la.d_type) ) {
+	} else if( FIRST_for_statement.contains(la.d_code) ) {
 		for_statement(st);
 	} else
 		invalid("conditional_statement");
 }
 
-void Parser::if_clause(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_if_clause, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::if_clause(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_if_clause, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_IF, false, "if_clause") ) addTerminal(st);
 	Boolean_expression(st);
 	if( expect(Tok_THEN, false, "if_clause") ) addTerminal(st);
 }
 
-void Parser::for_statement(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_for_statement, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::for_statement(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_for_statement, la); st->d_children.append(tmp); st = tmp; }
 	for_clause(st);
 	statement(st);
 }
 
-void Parser::for_clause(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_for_clause, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::for_clause(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_for_clause, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_FOR, false, "for_clause") ) addTerminal(st);
 	variable(st);
 	if( expect(Tok_ColonEq, false, "for_clause") ) addTerminal(st);
@@ -1191,8 +699,8 @@ void Parser::for_clause(SynTree* st) {
 	if( expect(Tok_DO, false, "for_clause") ) addTerminal(st);
 }
 
-void Parser::for_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_for_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::for_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_for_list, la); st->d_children.append(tmp); st = tmp; }
 	for_list_element(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "for_list") ) addTerminal(st);
@@ -1200,8 +708,8 @@ void Parser::for_list(SynTree* st) {
 	}
 }
 
-void Parser::for_list_element(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_for_list_element, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::for_list_element(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_for_list_element, la); st->d_children.append(tmp); st = tmp; }
 	arithmetic_expression(st);
 	if( la.d_type == Tok_STEP || la.d_type == Tok_WHILE ) {
 		if( la.d_type == Tok_STEP ) {
@@ -1217,38 +725,41 @@ void Parser::for_list_element(SynTree* st) {
 	}
 }
 
-void Parser::expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_expression, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_expression);
 	Boolean_expression(st);
+	closeChain(chain);
 }
 
-void Parser::arithmetic_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_arithmetic_expression, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_simple_arithmetic_expression(la.d_type) ) {
+template<class S> void ParserT<S>::arithmetic_expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_arithmetic_expression);
+	if( FIRST_simple_arithmetic_expression.contains(la.d_code) ) {
 		simple_arithmetic_expression(st);
-	} else if( FIRST_if_clause(la.d_type) ) {
+	} else if( FIRST_if_clause.contains(la.d_code) ) {
 		if_clause(st);
 		simple_arithmetic_expression(st);
 		if( expect(Tok_ELSE, false, "arithmetic_expression") ) addTerminal(st);
 		arithmetic_expression(st);
 	} else
 		invalid("arithmetic_expression");
+	closeChain(chain);
 }
 
-void Parser::simple_arithmetic_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_simple_arithmetic_expression, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_adding_operator(la.d_type) ) {
+template<class S> void ParserT<S>::simple_arithmetic_expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_simple_arithmetic_expression);
+	if( FIRST_adding_operator.contains(la.d_code) ) {
 		adding_operator(st);
 	}
 	term(st);
-	while( FIRST_adding_operator(la.d_type) ) {
+	while( FIRST_adding_operator.contains(la.d_code) ) {
 		adding_operator(st);
 		term(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::adding_operator(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_adding_operator, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::adding_operator(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_adding_operator, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_Plus ) {
 		if( expect(Tok_Plus, false, "adding_operator") ) addTerminal(st);
 	} else if( la.d_type == Tok_Minus ) {
@@ -1257,17 +768,18 @@ void Parser::adding_operator(SynTree* st) {
 		invalid("adding_operator");
 }
 
-void Parser::term(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_term, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::term(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_term);
 	factor(st);
-	while( FIRST_multiplying_operator(la.d_type) || FIRST_multiplying_operator(la.d_code) ) {
+	while( FIRST_multiplying_operator.contains(la.d_code) ) {
 		multiplying_operator(st);
 		factor(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::multiplying_operator(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_multiplying_operator, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::multiplying_operator(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_multiplying_operator, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_Star ) {
 		if( expect(Tok_Star, false, "multiplying_operator") ) addTerminal(st);
 	} else if( la.d_type == Tok_Slash ) {
@@ -1286,17 +798,18 @@ void Parser::multiplying_operator(SynTree* st) {
 		invalid("multiplying_operator");
 }
 
-void Parser::factor(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_factor, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::factor(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_factor);
 	primary(st);
-	while( FIRST_power_sym_(la.d_type) || FIRST_power_sym_(la.d_code) ) {
+	while( FIRST_power_sym_.contains(la.d_code) ) {
 		power_sym_(st);
 		primary(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::power_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_power_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::power_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_power_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_POWER ) {
 		if( expect(Tok_POWER, true, "power_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Uexp ) {
@@ -1309,11 +822,11 @@ void Parser::power_sym_(SynTree* st) {
 		invalid("power_sym_");
 }
 
-void Parser::primary(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_primary, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_unsigned_number(la.d_type) ) {
+template<class S> void ParserT<S>::primary(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_primary);
+	if( FIRST_unsigned_number.contains(la.d_code) ) {
 		unsigned_number(st);
-	} else if( FIRST_variableOrFunction_(la.d_type) ) {
+	} else if( FIRST_variableOrFunction_.contains(la.d_code) ) {
 		variableOrFunction_(st);
 	} else if( la.d_type == Tok_Lpar ) {
 		if( expect(Tok_Lpar, false, "primary") ) addTerminal(st);
@@ -1321,50 +834,55 @@ void Parser::primary(SynTree* st) {
 		if( expect(Tok_Rpar, false, "primary") ) addTerminal(st);
 	} else
 		invalid("primary");
+	closeChain(chain);
 }
 
-void Parser::designational_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_designational_expression, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_simple_designational_expression(la.d_type) ) {
+template<class S> void ParserT<S>::designational_expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_designational_expression);
+	if( FIRST_simple_designational_expression.contains(la.d_code) ) {
 		simple_designational_expression(st);
-	} else if( FIRST_if_clause(la.d_type) ) {
+	} else if( FIRST_if_clause.contains(la.d_code) ) {
 		if_clause(st);
 		simple_designational_expression(st);
 		if( expect(Tok_ELSE, false, "designational_expression") ) addTerminal(st);
 		designational_expression(st);
 	} else
 		invalid("designational_expression");
+	closeChain(chain);
 }
 
-void Parser::simple_designational_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_simple_designational_expression, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::simple_designational_expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_simple_designational_expression);
 	primary(st);
+	closeChain(chain);
 }
 
-void Parser::Boolean_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_Boolean_expression, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_simple_Boolean(la.d_type) || FIRST_simple_Boolean(la.d_code) ) {
+template<class S> void ParserT<S>::Boolean_expression(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_Boolean_expression);
+	if( FIRST_simple_Boolean.contains(la.d_code) ) {
 		simple_Boolean(st);
-	} else if( FIRST_if_clause(la.d_type) ) {
+	} else if( FIRST_if_clause.contains(la.d_code) ) {
 		if_clause(st);
 		simple_Boolean(st);
 		if( expect(Tok_ELSE, false, "Boolean_expression") ) addTerminal(st);
 		Boolean_expression(st);
 	} else
 		invalid("Boolean_expression");
+	closeChain(chain);
 }
 
-void Parser::simple_Boolean(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_simple_Boolean, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::simple_Boolean(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_simple_Boolean);
 	implication(st);
-	while( FIRST_equiv_sym_(la.d_type) || FIRST_equiv_sym_(la.d_code) ) {
+	while( FIRST_equiv_sym_.contains(la.d_code) ) {
 		equiv_sym_(st);
 		implication(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::equiv_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_equiv_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::equiv_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_equiv_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_EQUIV ) {
 		if( expect(Tok_EQUIV, true, "equiv_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Ueq ) {
@@ -1375,17 +893,18 @@ void Parser::equiv_sym_(SynTree* st) {
 		invalid("equiv_sym_");
 }
 
-void Parser::implication(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_implication, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::implication(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_implication);
 	Boolean_term(st);
-	while( FIRST_impl_sym_(la.d_type) || FIRST_impl_sym_(la.d_code) ) {
+	while( FIRST_impl_sym_.contains(la.d_code) ) {
 		impl_sym_(st);
 		Boolean_term(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::impl_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_impl_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::impl_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_impl_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_IMPL ) {
 		if( expect(Tok_IMPL, true, "impl_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Uimpl ) {
@@ -1396,17 +915,18 @@ void Parser::impl_sym_(SynTree* st) {
 		invalid("impl_sym_");
 }
 
-void Parser::Boolean_term(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_Boolean_term, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::Boolean_term(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_Boolean_term);
 	Boolean_factor(st);
-	while( FIRST_or_sym_(la.d_type) || FIRST_or_sym_(la.d_code) ) {
+	while( FIRST_or_sym_.contains(la.d_code) ) {
 		or_sym_(st);
 		Boolean_factor(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::or_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_or_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::or_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_or_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_OR ) {
 		if( expect(Tok_OR, true, "or_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Uor ) {
@@ -1417,17 +937,18 @@ void Parser::or_sym_(SynTree* st) {
 		invalid("or_sym_");
 }
 
-void Parser::Boolean_factor(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_Boolean_factor, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::Boolean_factor(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_Boolean_factor);
 	Boolean_secondary(st);
-	while( FIRST_and_sym_(la.d_type) || FIRST_and_sym_(la.d_code) ) {
+	while( FIRST_and_sym_.contains(la.d_code) ) {
 		and_sym_(st);
 		Boolean_secondary(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::and_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_and_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::and_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_and_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_AND ) {
 		if( expect(Tok_AND, true, "and_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Uand ) {
@@ -1438,19 +959,20 @@ void Parser::and_sym_(SynTree* st) {
 		invalid("and_sym_");
 }
 
-void Parser::Boolean_secondary(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_Boolean_secondary, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_not_sym_(la.d_type) || FIRST_not_sym_(la.d_code) ) {
+template<class S> void ParserT<S>::Boolean_secondary(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_Boolean_secondary);
+	if( FIRST_not_sym_.contains(la.d_code) ) {
 		not_sym_(st);
 		Boolean_primary(st);
-	} else if( FIRST_Boolean_primary(la.d_type) ) {
+	} else if( FIRST_Boolean_primary.contains(la.d_code) ) {
 		Boolean_primary(st);
 	} else
 		invalid("Boolean_secondary");
+	closeChain(chain);
 }
 
-void Parser::not_sym_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_not_sym_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::not_sym_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_not_sym_, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_code == Tok_NOT ) {
 		if( expect(Tok_NOT, true, "not_sym_") ) addTerminal(st);
 	} else if( la.d_type == Tok_Unot ) {
@@ -1461,27 +983,29 @@ void Parser::not_sym_(SynTree* st) {
 		invalid("not_sym_");
 }
 
-void Parser::Boolean_primary(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_Boolean_primary, la); st->d_children.append(tmp); st = tmp; }
-	if( FIRST_logical_value(la.d_type) ) {
+template<class S> void ParserT<S>::Boolean_primary(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_Boolean_primary);
+	if( FIRST_logical_value.contains(la.d_code) ) {
 		logical_value(st);
-	} else if( FIRST_relation(la.d_type) ) {
+	} else if( FIRST_relation.contains(la.d_code) ) {
 		relation(st);
 	} else
 		invalid("Boolean_primary");
+	closeChain(chain);
 }
 
-void Parser::relation(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_relation, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::relation(SynTree* st) {
+	const Chain chain = openChain(st, SynTree::R_relation);
 	simple_arithmetic_expression(st);
-	if( FIRST_relational_operator(la.d_type) || FIRST_relational_operator(la.d_code) ) {
+	if( FIRST_relational_operator.contains(la.d_code) ) {
 		relational_operator(st);
 		simple_arithmetic_expression(st);
 	}
+	closeChain(chain);
 }
 
-void Parser::relational_operator(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_relational_operator, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::relational_operator(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_relational_operator, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_Lt ) {
 		if( expect(Tok_Lt, false, "relational_operator") ) addTerminal(st);
 	} else if( la.d_type == Tok_Leq ) {
@@ -1520,8 +1044,8 @@ void Parser::relational_operator(SynTree* st) {
 		invalid("relational_operator");
 }
 
-void Parser::variableOrFunction_(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_variableOrFunction_, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::variableOrFunction_(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_variableOrFunction_, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "variableOrFunction_") ) addTerminal(st);
 	if( la.d_type == Tok_Lbrack || la.d_type == Tok_Lpar ) {
 		if( la.d_type == Tok_Lbrack ) {
@@ -1537,8 +1061,8 @@ void Parser::variableOrFunction_(SynTree* st) {
 	}
 }
 
-void Parser::variable(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_variable, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::variable(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_variable, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "variable") ) addTerminal(st);
 	if( la.d_type == Tok_Lbrack ) {
 		if( expect(Tok_Lbrack, false, "variable") ) addTerminal(st);
@@ -1547,18 +1071,18 @@ void Parser::variable(SynTree* st) {
 	}
 }
 
-void Parser::simple_variable(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_simple_variable, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::simple_variable(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_simple_variable, la); st->d_children.append(tmp); st = tmp; }
 	variable_identifier(st);
 }
 
-void Parser::variable_identifier(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_variable_identifier, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::variable_identifier(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_variable_identifier, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "variable_identifier") ) addTerminal(st);
 }
 
-void Parser::subscript_list(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_subscript_list, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::subscript_list(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_subscript_list, la); st->d_children.append(tmp); st = tmp; }
 	subscript_expression(st);
 	while( la.d_type == Tok_Comma ) {
 		if( expect(Tok_Comma, false, "subscript_list") ) addTerminal(st);
@@ -1566,13 +1090,13 @@ void Parser::subscript_list(SynTree* st) {
 	}
 }
 
-void Parser::subscript_expression(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_subscript_expression, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::subscript_expression(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_subscript_expression, la); st->d_children.append(tmp); st = tmp; }
 	arithmetic_expression(st);
 }
 
-void Parser::unsigned_number(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_unsigned_number, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::unsigned_number(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_unsigned_number, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_unsigned_integer ) {
 		if( expect(Tok_unsigned_integer, false, "unsigned_number") ) addTerminal(st);
 	} else if( la.d_type == Tok_decimal_number ) {
@@ -1581,13 +1105,13 @@ void Parser::unsigned_number(SynTree* st) {
 		invalid("unsigned_number");
 }
 
-void Parser::letter_string(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_letter_string, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::letter_string(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_letter_string, la); st->d_children.append(tmp); st = tmp; }
 	if( expect(Tok_identifier, false, "letter_string") ) addTerminal(st);
 }
 
-void Parser::logical_value(SynTree* st) {
-	{ SynTree* tmp = new SynTree(SynTree::R_logical_value, la); st->d_children.append(tmp); st = tmp; }
+template<class S> void ParserT<S>::logical_value(SynTree* st) {
+	{ SynTree* tmp = arena.create(SynTree::R_logical_value, la); st->d_children.append(tmp); st = tmp; }
 	if( la.d_type == Tok_TRUE ) {
 		if( expect(Tok_TRUE, false, "logical_value") ) addTerminal(st);
 	} else if( la.d_type == Tok_FALSE ) {
@@ -1596,3 +1120,7 @@ void Parser::logical_value(SynTree* st) {
 		invalid("logical_value");
 }
 
+namespace Alg {
+	template class ParserT<Scanner>;
+	template class ParserT<Lexer>;
+}
@@ -1,6 +1,11 @@
 #ifndef __ALG_PARSER__
 #define __ALG_PARSER__
-// This file was automatically generated by EbnfStudio; don't modify it!
+// This file was originally generated by EbnfStudio from syntax/Algol60.ebnf; it is now maintained by hand
+// and must not be overwritten by a regenerated version. Changes to the generated code:
+// - the nodes are allocated from the arena of the parser, which owns them
+// - optional elision of single child expression and statement rules, see elideChains
+// - the parser is a template on its scanner, see ParserT
+// - the parser keeps its own lookahead window and doesn't call Scanner::peek
 
 #include <Algol/AlgSynTree.h>
 
@@ -12,18 +17,30 @@ namespace Alg {
 		virtual Token peek(int offset) = 0;
 	};
 
-	class Parser {
+	struct ParserError {
+	    QString msg;
+	    int row, col;
+	    QString path;
+	    ParserError( const QString& m, int r, int c, const QString& p):msg(m),row(r),col(c),path(p){}
+	};
+
+	// S provides Token next(); the parser keeps its own lookahead and doesn't use Scanner::peek. AlgParser.cpp
+	// instantiates the parser for the virtual Scanner interface and for the Lexer, which it calls directly
+	template<class S> class ParserT {
 	public:
-		Parser(Scanner* s):scanner(s) {}
+		ParserT(S* s):elideChains(false),scanner(s) {}
 		void RunParser();
+		// the nodes below root belong to arena, so the tree is only valid until the next RunParser or the
+		// destruction of the parser; a tree which has to live longer can be copied into a FlatTree
 		SynTree root;
-		struct Error {
-		    QString msg;
-		    int row, col;
-		    QString path;
-		    Error( const QString& m, int r, int c, const QString& p):msg(m),row(r),col(c),path(p){}
-		};
+		SynTreeArena arena;
+		typedef ParserError Error;
 		QList<Error> errors;
+		// if set, the precedence levels from expression and Boolean_expression down to primary, the designational
+		// expressions and the statement wrappers from unconditional_statement down to unlabelled_basic_statement
+		// get no node of their own when they have exactly one child; the child keeps its own position. Otherwise,
+		// and also when a syntax error left the rule without children, the node is the same as without elision
+		bool elideChains;
 	protected:
 		void program(SynTree*);
 		void declarations_(SynTree*);
@@ -109,12 +126,24 @@ namespace Alg {
 	protected:
 		Token cur;
 		Token la;
-		Scanner* scanner;
+		S* scanner;
 		void next();
-		Token peek(int off);
+		const Token& peek(int off); // valid until the next call of next or peek
+		TokenRing window; // the tokens following la which were fetched by peek
+		Token fetch() { return window.isEmpty() ? scanner->next() : window.take_front(); }
 		void invalid(const char* what);
 		bool expect(int tt, bool pkw, const char* where);
 		void addTerminal(SynTree* st);
+		struct Chain {
+			SynTree* up; // the parent of the rule, 0 if the rule has its node already
+			SynTree* prev; // the last child of up before the rule, if any
+			int first;
+			SynToken tok; // the node of the rule if it is not elided, made from the token the rule starts with
+		};
+		Chain openChain(SynTree*& st, quint16 r);
+		void closeChain(const Chain&);
 	};
+
+	typedef ParserT<Scanner> Parser;
 }
 #endif // include
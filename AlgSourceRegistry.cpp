@@ -0,0 +1,151 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "AlgSourceRegistry.h"
+#include "AlgLexer.h"
+#include "AlgSymbols.h"
+#include <string.h>
+using namespace Alg;
+
+SourceRegistry::SourceRegistry(QObject *parent) : QObject(parent)
+{
+}
+
+quint32 SourceRegistry::addSource(const QString& path, const QByteArray& utf8)
+{
+    Source s;
+    s.d_path = path;
+    s.d_buf = utf8;
+    d_lock.lockForWrite();
+    d_sources.append(s);
+    const quint32 res = d_sources.size();
+    d_lock.unlock();
+    return res;
+}
+
+QString SourceRegistry::path(quint32 fileId) const
+{
+    QString res;
+    d_lock.lockForRead();
+    if( fileId > 0 && fileId <= quint32(d_sources.size()) )
+        res = d_sources.at(fileId-1).d_path;
+    d_lock.unlock();
+    return res;
+}
+
+QByteArray SourceRegistry::buffer(quint32 fileId) const
+{
+    QByteArray res;
+    d_lock.lockForRead();
+    if( fileId > 0 && fileId <= quint32(d_sources.size()) )
+        res = d_sources.at(fileId-1).d_buf;
+    d_lock.unlock();
+    return res;
+}
+
+quint32 SourceRegistry::count() const
+{
+    d_lock.lockForRead();
+    const quint32 res = d_sources.size();
+    d_lock.unlock();
+    return res;
+}
+
+LineIndex SourceRegistry::lineIndex(quint32 fileId) const
+{
+    LineIndex res;
+    d_lock.lockForRead();
+    const bool valid = fileId > 0 && fileId <= quint32(d_sources.size());
+    if( valid )
+        res = d_sources.at(fileId-1).d_lines;
+    d_lock.unlock();
+    if( valid && res.isEmpty() )
+    {
+        d_lock.lockForWrite();
+        Source& s = d_sources[fileId-1];
+        if( s.d_lines.isEmpty() )
+            s.d_lines.build( s.d_buf );
+        res = s.d_lines;
+        d_lock.unlock();
+    }
+    return res;
+}
+
+QByteArray SourceRegistry::text(const CompactToken& t) const
+{
+    const QByteArray buf = buffer(t.d_fileId);
+    if( quint64(t.d_offset) + t.d_len > quint64(buf.size()) )
+        return QByteArray();
+    return buf.mid( t.d_offset, t.d_len );
+}
+
+static QByteArray normalize( const QByteArray& str )
+{
+    // the lexer ignores underlines (U+0332) and joins the lines of a comment by '\n'
+    if( ::memchr( str.constData(), '\r', str.size() ) == 0 && !str.contains("\xcc\xb2") )
+        return str;
+    QByteArray res;
+    res.reserve( str.size() );
+    for( int i = 0; i < str.size(); i++ )
+    {
+        const char c = str[i];
+        if( c == '\r' && i + 1 < str.size() && str[i+1] == '\n' )
+            continue;
+        if( c == '\xcc' && i + 1 < str.size() && str[i+1] == '\xb2' )
+        {
+            i++;
+            continue;
+        }
+        res += c;
+    }
+    return res;
+}
+
+QByteArray SourceRegistry::value(const CompactToken& t) const
+{
+    if( tokenTypeIsKeyword(t.d_type) || t.d_code != t.d_type || t.d_type == Tok_Eof )
+        return QByteArray(); // keywords and pseudo-keywords have no value
+    QByteArray str = normalize( text(t) );
+    if( t.d_type == Tok_Comment )
+    {
+        // the lexer drops the line breaks as long as the comment text is empty
+        int i = 0;
+        while( i < str.size() && str[i] == '\n' )
+            i++;
+        return str.mid(i);
+    }
+    if( t.d_type == Tok_Invalid )
+        return str; // the lexer puts the error message in invalid tokens, which is not recovered
+    return Symbols::intern( str );
+}
+
+Token SourceRegistry::toToken(const CompactToken& ct) const
+{
+    quint32 line, col;
+    lineIndex(ct.d_fileId).position( ct.d_offset, &line, &col );
+    const QByteArray val = value(ct);
+    const QByteArray str = ct.d_type == Tok_Comment ? val : text(ct); // comment lines are joined by '\n'
+    Token t( ct.d_type, line, col, LineIndex::utf16Len( str.constData(), str.size() ), val );
+    t.d_code = ct.d_code;
+    Lexer::decodeNumber( t );
+    t.d_offset = ct.d_offset;
+    t.d_byteLen = ct.d_len;
+    t.d_sourcePath = path(ct.d_fileId);
+    return t;
+}
@@ -0,0 +1,61 @@
+#ifndef ALGSOURCEREGISTRY_H
+#define ALGSOURCEREGISTRY_H
+
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QReadWriteLock>
+#include <QVector>
+#include <Algol/AlgToken.h>
+#include <Algol/AlgLineIndex.h>
+
+namespace Alg
+{
+    class SourceRegistry : public QObject
+    {
+        // this class is thread-safe
+    public:
+        explicit SourceRegistry(QObject *parent = 0);
+
+        quint32 addSource( const QString& path, const QByteArray& utf8 ); // returns a new file id on each call, never 0
+        QString path( quint32 fileId ) const;
+        QByteArray buffer( quint32 fileId ) const;
+        quint32 count() const;
+        LineIndex lineIndex( quint32 fileId ) const; // built on first use
+
+        QByteArray text( const CompactToken& ) const; // the source text of the token
+        QByteArray value( const CompactToken& ) const; // what the lexer puts in Token::d_val
+        Token toToken( const CompactToken& ) const;
+
+    private:
+        struct Source
+        {
+            QString d_path;
+            QByteArray d_buf;
+            LineIndex d_lines;
+        };
+        // fileId - 1 -> source; the line index is added on demand. Only at() is used under the read lock,
+        // because operator[] of the mutable vector could detach it while other readers access it
+        mutable QVector<Source> d_sources;
+        mutable QReadWriteLock d_lock;
+    };
+}
+
+#endif // ALGSOURCEREGISTRY_H
@@ -0,0 +1,222 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "AlgSymbols.h"
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QList>
+#include <string.h>
+using namespace Alg;
+
+// The strings are distributed over the shards by hash. Each shard has an open addressing table
+// of entry pointers which is only written under the lock of the shard. Readers never lock: they
+// load the current table and probe it with acquire loads. An entry is fully constructed before it
+// is published, and a grown table is fully populated before it replaces the old one; the old
+// tables are kept alive, because readers could still be probing them. Atoms are resolved in a
+// segmented array per shard whose segments never move.
+
+enum { ShardBits = 6, Shards = 1 << ShardBits, SegBase = 256, MaxSegments = 18, MinSlots = 64 };
+
+// an atom is the index in its shard shifted by ShardBits, or'ed with the shard and incremented; the
+// segments of a shard hold fewer entries than the 32 - ShardBits bits left for the index can encode
+static_assert( quint64(SegBase) * ( ( 1u << MaxSegments ) - 1 ) < ( 1u << ( 32 - ShardBits ) ),
+               "the entries of a shard exceed the range of the atoms" );
+
+struct Entry
+{
+    QByteArray d_str;
+    quint32 d_hash;
+    Symbols::Atom d_atom;
+};
+
+struct Table
+{
+    quint32 d_mask;
+    QAtomicPointer<Entry>* d_slots;
+    explicit Table( quint32 size ):d_mask(size-1),d_slots(new QAtomicPointer<Entry>[size]) {}
+};
+
+struct Shard
+{
+    QMutex d_lock;
+    QAtomicPointer<Table> d_table;
+    QAtomicPointer<Entry>* d_segments[MaxSegments]; // written under the lock before the atoms are handed out
+    QAtomicInt d_count; // number of entries, also the local index of the next atom
+    QList<Table*> d_retired;
+    Shard():d_table(new Table(MinSlots)) { ::memset( d_segments, 0, sizeof(d_segments) ); }
+};
+
+static inline quint32 hash( const char* str, int len )
+{
+    // FNV-1a
+    quint32 h = 2166136261u;
+    for( int i = 0; i < len; i++ )
+    {
+        h ^= (uchar)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline int segment( quint32 index, quint32* offset )
+{
+    // segment s has SegBase * 2^s slots
+    quint32 n = index / SegBase + 1;
+    int s = 0;
+    while( n > 1 )
+    {
+        n >>= 1;
+        s++;
+    }
+    *offset = index - ( ( 1u << s ) - 1 ) * SegBase;
+    return s;
+}
+
+static Shard* shards()
+{
+    static Shard s[Shards];
+    return s;
+}
+
+static inline bool equals( const Entry* e, quint32 h, const char* str, int len )
+{
+    return e->d_hash == h && e->d_str.size() == len && ::memcmp( e->d_str.constData(), str, len ) == 0;
+}
+
+static const Entry* find( const Table* t, quint32 h, const char* str, int len, quint32* slot )
+{
+    // the table is never full, so the probe sequence always meets an empty slot
+    quint32 i = ( h >> ShardBits ) & t->d_mask;
+    while( true )
+    {
+        const Entry* e = t->d_slots[i].loadAcquire();
+        if( e == 0 )
+        {
+            *slot = i;
+            return 0;
+        }
+        if( equals( e, h, str, len ) )
+            return e;
+        i = ( i + 1 ) & t->d_mask;
+    }
+}
+
+static const Entry* lookup( const char* str, int len )
+{
+    const quint32 h = hash( str, len );
+    Shard& s = shards()[ h & ( Shards - 1 ) ];
+    quint32 slot;
+    const Entry* e = find( s.d_table.loadAcquire(), h, str, len, &slot );
+    if( e )
+        return e;
+
+    QMutexLocker lock( &s.d_lock );
+    Table* t = s.d_table.loadAcquire();
+    e = find( t, h, str, len, &slot ); // another thread could have inserted it in the meantime
+    if( e )
+        return e;
+
+    const quint32 index = s.d_count.loadAcquire();
+    quint32 offset;
+    const int seg = segment( index, &offset );
+    if( seg >= MaxSegments )
+        qFatal( "Alg::Symbols: more than %d symbols in a shard", SegBase * ( ( 1 << MaxSegments ) - 1 ) );
+    if( s.d_segments[seg] == 0 )
+        s.d_segments[seg] = new QAtomicPointer<Entry>[ SegBase << seg ];
+
+    Entry* n = new Entry();
+    n->d_str = QByteArray( str, len ); // deep copy, str could be raw data
+    n->d_hash = h;
+    n->d_atom = ( ( index << ShardBits ) | ( h & ( Shards - 1 ) ) ) + 1;
+    s.d_segments[seg][offset].storeRelease( n );
+    s.d_count.storeRelease( index + 1 ); // before publishing, so that symbol() resolves the atom of any visible entry
+
+    if( ( index + 1 ) * 2 > t->d_mask + 1 )
+    {
+        // keep the load factor below 1/2; readers continue on the old table until the new one is published
+        Table* g = new Table( ( t->d_mask + 1 ) * 2 );
+        for( quint32 i = 0; i <= t->d_mask; i++ )
+        {
+            Entry* o = t->d_slots[i].loadAcquire();
+            if( o == 0 )
+                continue;
+            quint32 j = ( o->d_hash >> ShardBits ) & g->d_mask;
+            while( g->d_slots[j].loadAcquire() != 0 )
+                j = ( j + 1 ) & g->d_mask;
+            g->d_slots[j].storeRelease( o );
+        }
+        find( g, h, str, len, &slot );
+        g->d_slots[slot].storeRelease( n );
+        s.d_table.storeRelease( g );
+        s.d_retired.append( t );
+    }else
+        t->d_slots[slot].storeRelease( n );
+    return n;
+}
+
+QByteArray Symbols::intern(const char* str, int len, Symbols::Atom* atom)
+{
+    if( len <= 0 )
+    {
+        if( atom )
+            *atom = 0;
+        return QByteArray();
+    }
+    const Entry* e = lookup( str, len );
+    if( atom )
+        *atom = e->d_atom;
+    return e->d_str;
+}
+
+QByteArray Symbols::intern(const QByteArray& str, Symbols::Atom* atom)
+{
+    return intern( str.constData(), str.size(), atom );
+}
+
+Symbols::Atom Symbols::atom(const char* str, int len)
+{
+    if( len <= 0 )
+        return 0;
+    return lookup( str, len )->d_atom;
+}
+
+QByteArray Symbols::symbol(Symbols::Atom a)
+{
+    if( a == 0 )
+        return QByteArray();
+    a--;
+    Shard& s = shards()[ a & ( Shards - 1 ) ];
+    const quint32 index = a >> ShardBits;
+    if( index >= quint32(s.d_count.loadAcquire()) )
+        return QByteArray();
+    quint32 offset;
+    const int seg = segment( index, &offset );
+    const Entry* e = s.d_segments[seg][offset].loadAcquire();
+    Q_ASSERT( e != 0 );
+    return e->d_str;
+}
+
+quint32 Symbols::count()
+{
+    quint32 res = 0;
+    for( int i = 0; i < Shards; i++ )
+        res += shards()[i].d_count.loadAcquire();
+    return res;
+}
@@ -0,0 +1,45 @@
+#ifndef ALGSYMBOLS_H
+#define ALGSYMBOLS_H
+
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QByteArray>
+
+namespace Alg
+{
+    class Symbols
+    {
+        // this class is thread-safe; symbols are interned for the lifetime of the process.
+        // Lookup of already interned strings and of atoms is wait-free, only the first
+        // occurrence of a string takes the lock of one of the shards.
+    public:
+        typedef quint32 Atom; // 0 is the empty string
+
+        static QByteArray intern( const char* str, int len, Atom* atom = 0 );
+        static QByteArray intern( const QByteArray& str, Atom* atom = 0 );
+        static Atom atom( const char* str, int len ); // interns if not yet present
+        static QByteArray symbol( Atom ); // returns an empty string for unknown atoms
+        static quint32 count();
+    private:
+        Symbols();
+    };
+}
+
+#endif // ALGSYMBOLS_H
@@ -1,11 +1,39 @@
-// This file was automatically generated by EbnfStudio; don't modify it!
+// This file was originally generated by EbnfStudio from syntax/Algol60.ebnf; it is now maintained by hand
+// and must not be overwritten by a regenerated version. Changes to the generated code:
+// - the nodes are allocated from a SynTreeArena and are trivially destructible
 #include "AlgSynTree.h"
+#include <type_traits>
 using namespace Alg;
 
-SynTree::SynTree(quint16 r, const Token& t ):d_tok(r){
-	d_tok.d_lineNr = t.d_lineNr;
-	d_tok.d_colNr = t.d_colNr;
-	d_tok.d_sourcePath = t.d_sourcePath;
+static_assert( std::is_trivially_destructible<SynTree>::value, "SynTreeArena::clear doesn't run destructors" );
+
+Token SynToken::toToken(const QString& sourcePath) const {
+	Token t(d_type, d_lineNr, d_colNr, d_len, value());
+	t.d_code = d_code;
+	t.d_offset = d_offset;
+	t.d_byteLen = d_byteLen;
+	t.d_int = d_int;
+	t.d_sourcePath = sourcePath;
+	return t;
+}
+
+void SynTree::Children::moveTail(SynTree* prev, int from, Children& other) {
+	SynTree* head = prev ? prev->d_next : d_first;
+	if( head == 0 )
+		return;
+	if( other.d_last ) other.d_last->d_next = head; else other.d_first = head;
+	other.d_last = d_last;
+	other.d_count += d_count - from;
+	d_last = prev;
+	if( prev ) prev->d_next = 0; else d_first = 0;
+	d_count = from;
+}
+
+SynTree* SynTree::Children::at(int i) const {
+	SynTree* n = d_first;
+	while( n && i-- > 0 )
+		n = n->d_next;
+	return n;
 }
 
 const char* SynTree::rToStr( quint16 r ) {
@@ -95,3 +123,18 @@ const char* SynTree::rToStr( quint16 r ) {
 	default: if(r<R_First) return tokenTypeName(r); else return "";
 }
 }
+
+void SynTreeArena::grow() {
+	d_blocks.append( static_cast<SynTree*>( ::operator new( BlockSize * sizeof(SynTree) ) ) );
+	d_used = 0;
+}
+
+void SynTreeArena::clear() {
+	// the nodes are trivially destructible, see the static_assert above
+	foreach( SynTree* block, d_blocks )
+		::operator delete( block );
+	d_blocks.clear();
+	d_used = BlockSize;
+	d_path = QString();
+	d_pathAtom = 0;
+}
@@ -1,13 +1,40 @@
 #ifndef __ALG_SYNTREE__
 #define __ALG_SYNTREE__
-// This file was automatically generated by EbnfStudio; don't modify it!
+// This file was originally generated by EbnfStudio from syntax/Algol60.ebnf; it is now maintained by hand
+// and must not be overwritten by a regenerated version. Changes to the generated code:
+// - the nodes are allocated from a SynTreeArena and are trivially destructible
 
 #include <Algol/AlgTokenType.h>
 #include <Algol/AlgToken.h>
+#include <Algol/AlgSymbols.h>
 #include <QList>
 
 namespace Alg {
 
+	struct SynToken {
+		// the token of a node; unlike Token it is trivially destructible, because the value and the source path
+		// are held as atoms of Symbols, which keeps the strings for the lifetime of the process
+		quint16 d_type; // TokenType or SynTree::ParserRule
+		quint16 d_code; // see Token::d_code
+		quint32 d_lineNr;
+		quint32 d_colNr, d_len; // counts unicode chars, not bytes!
+		quint32 d_offset, d_byteLen; // utf-8 span in the source buffer
+		union {
+		qint64 d_int;
+		double d_real;
+		};
+		Symbols::Atom d_valAtom, d_pathAtom;
+		SynToken(quint16 t = Tok_Invalid):d_type(t),d_code(t),d_lineNr(0),d_colNr(0),d_len(0),d_offset(0),
+			d_byteLen(0),d_int(0),d_valAtom(0),d_pathAtom(0){}
+		QByteArray value() const { return Symbols::symbol(d_valAtom); }
+		QString sourcePath() const { return QString::fromUtf8(Symbols::symbol(d_pathAtom)); }
+		bool isValid() const { return d_type != Tok_Eof && d_type != Tok_Invalid; }
+		const char* getName() const { return tokenTypeName(d_type); }
+		const char* getString() const { return tokenTypeString(d_type); }
+		Token toToken() const { return toToken(sourcePath()); }
+		Token toToken( const QString& sourcePath ) const; // sourcePath is the one of d_pathAtom
+	};
+
 	struct SynTree {
 		enum ParserRule {
 			R_First = TT_Max + 1,
@@ -95,14 +122,104 @@ namespace Alg {
 			R_variable_identifier,
 			R_Last
 		};
-		SynTree(quint16 r = Tok_Invalid, const Token& = Token() );
-		SynTree(const Token& t ):d_tok(t){}
-		~SynTree() { foreach(SynTree* n, d_children) delete n; }
+		class Children {
+			// the children are linked through SynTree::d_next, so a node is the child of at most one list;
+			// the list doesn't own them, the nodes belong to a SynTreeArena
+		public:
+			class const_iterator {
+			public:
+				const_iterator(SynTree* n = 0):d_node(n){}
+				SynTree* operator*() const { return d_node; }
+				const_iterator& operator++() { d_node = d_node->d_next; return *this; }
+				bool operator==(const const_iterator& rhs) const { return d_node == rhs.d_node; }
+				bool operator!=(const const_iterator& rhs) const { return d_node != rhs.d_node; }
+			private:
+				SynTree* d_node;
+			};
+			typedef const_iterator iterator;
+			Children():d_first(0),d_last(0),d_count(0){}
+			void append( SynTree* n ) {
+				n->d_next = 0;
+				if( d_last ) d_last->d_next = n; else d_first = n;
+				d_last = n;
+				d_count++;
+			}
+			// moves the children following prev, which is the child at index from - 1 or 0 if from is 0,
+			// to the end of other
+			void moveTail( SynTree* prev, int from, Children& other );
+			void clear() { d_first = d_last = 0; d_count = 0; }
+			int size() const { return d_count; }
+			int count() const { return d_count; }
+			bool isEmpty() const { return d_count == 0; }
+			SynTree* first() const { return d_first; }
+			SynTree* last() const { return d_last; }
+			SynTree* at( int i ) const; // walks the siblings
+			SynTree* operator[]( int i ) const { return at(i); }
+			const_iterator begin() const { return const_iterator(d_first); }
+			const_iterator end() const { return const_iterator(); }
+		private:
+			SynTree* d_first;
+			SynTree* d_last;
+			int d_count;
+		};
+
+		SynTree(quint16 r = Tok_Invalid):d_tok(r),d_next(0){}
+		SynTree(const SynToken& t):d_tok(t),d_next(0){}
 
 		static const char* rToStr( quint16 r );
 
-		Alg::Token d_tok;
-		QList<SynTree*> d_children;
+		SynToken d_tok;
+		Children d_children;
+		SynTree* d_next; // the next sibling
+	};
+
+	class SynTreeArena {
+	public:
+		// Owns all nodes of a parse. The nodes are trivially destructible, so clear() releases them
+		// by freeing the blocks, without visiting the nodes.
+		SynTreeArena():d_used(BlockSize),d_pathAtom(0) {}
+		~SynTreeArena() { clear(); }
+		// a rule node gets the position and span of t, i.e. of the token the rule starts with
+		SynTree* create( quint16 r, const Token& t ) { return new( alloc() ) SynTree(toSynToken(r, t)); }
+		SynTree* create( const Token& t ) { return new( alloc() ) SynTree(toSynToken(t)); }
+		SynTree* create( const SynToken& t ) { return new( alloc() ) SynTree(t); }
+		SynToken toSynToken( quint16 r, const Token& t ) { // the position of t with the type r
+			SynToken res(r);
+			res.d_lineNr = t.d_lineNr;
+			res.d_colNr = t.d_colNr;
+			res.d_len = t.d_len;
+			res.d_offset = t.d_offset;
+			res.d_byteLen = t.d_byteLen;
+			res.d_pathAtom = pathAtom(t.d_sourcePath);
+			return res;
+		}
+		SynToken toSynToken( const Token& t ) {
+			SynToken res = toSynToken(t.d_type, t);
+			res.d_code = t.d_code;
+			res.d_int = t.d_int;
+			res.d_valAtom = Symbols::atom(t.d_val.constData(), t.d_val.size());
+			return res;
+		}
+		void clear();
+		int count() const { return d_blocks.isEmpty() ? 0 : ( d_blocks.size() - 1 ) * BlockSize + d_used; }
+	private:
+		Q_DISABLE_COPY(SynTreeArena)
+		enum { BlockSize = 1024 }; // nodes per block
+		void* alloc() { if( d_used == BlockSize ) grow(); return d_blocks.last() + d_used++; }
+		void grow();
+		Symbols::Atom pathAtom( const QString& path ) {
+			// the tokens of a source share the path, so it is only interned when it changes
+			if( path != d_path ) {
+				d_path = path;
+				const QByteArray utf8 = path.toUtf8();
+				d_pathAtom = Symbols::atom(utf8.constData(), utf8.size());
+			}
+			return d_pathAtom;
+		}
+		QList<SynTree*> d_blocks; // uninitialized storage for BlockSize nodes each
+		int d_used; // nodes constructed in the last block
+		QString d_path;
+		Symbols::Atom d_pathAtom;
 	};
 
 }
@@ -20,6 +20,8 @@
 #include "AlgToken.h"
 using namespace Alg;
 
+Q_STATIC_ASSERT( sizeof(CompactToken) == 16 );
+
 bool Token::isValid() const
 {
     return d_type != Tok_Eof && d_type != Tok_Invalid;
@@ -40,3 +42,22 @@ const char*Token::getString() const
     return tokenTypeString(d_type);
 }
 
+CompactToken Token::toCompact(quint32 fileId) const
+{
+    CompactToken t;
+    t.d_type = d_type;
+    t.d_code = d_code;
+    t.d_fileId = fileId;
+    t.d_offset = d_offset;
+    t.d_len = d_byteLen;
+    return t;
+}
+
+void TokenRing::grow()
+{
+    QVector<Token> ring( d_ring.size() * 2 );
+    for( int i = 0; i < d_count; i++ )
+        ring[i] = std::move( d_ring[ ( d_head + i ) & ( d_ring.size() - 1 ) ] );
+    d_ring.swap( ring );
+    d_head = 0;
+}
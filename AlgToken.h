@@ -21,10 +21,21 @@
 */
 
 #include <QString>
+#include <QVector>
 #include <Algol/AlgTokenType.h>
 
 namespace Alg
 {
+    struct CompactToken
+    {
+        // trivially copyable 16 byte token for bulk storage; the value and the line/column position
+        // are recovered from the source buffer, see SourceRegistry
+        quint16 d_type; // TokenType
+        quint16 d_code;
+        quint32 d_fileId;
+        quint32 d_offset, d_len; // utf-8 span in the source buffer
+    };
+
     struct Token
     {
 #ifdef _DEBUG
@@ -40,19 +51,62 @@ namespace Alg
         };
 #else
         uint d_type : 16; // TokenType
-        uint d_code : 16;
+        uint d_code : 16; // d_type, except for pseudo keywords where d_type is Tok_identifier and d_code the keyword
 #endif
+        // line and column are kept besides the offset because errors, syntax trees and the highlighter report
+        // them after the lexer has moved on, and a streamed source is no longer available to a LineIndex;
+        // CompactToken is the offset only form
         quint32 d_lineNr;
-        quint16 d_colNr, d_len; // counts unicode chars, not bytes!
+        quint32 d_colNr, d_len; // counts unicode chars, not bytes!
+        quint32 d_offset, d_byteLen; // utf-8 span of the token in the source buffer
+        union
+        {
+        qint64 d_int; // value of a Tok_unsigned_integer, -1 if out of range
+        double d_real; // value of a Tok_decimal_number, +inf if out of range
+        };
         QByteArray d_val; // utf-8
         QString d_sourcePath;
-        Token(quint16 t = Tok_Invalid, quint32 line = 0, quint16 col = 0, quint16 len = 0, const QByteArray& val = QByteArray() ):
-            d_type(t),d_lineNr(line),d_colNr(col),d_len(len),d_val(val),d_code(0){}
+        Token(quint16 t = Tok_Invalid, quint32 line = 0, quint32 col = 0, quint32 len = 0, const QByteArray& val = QByteArray() ):
+            d_type(t),d_code(t),d_lineNr(line),d_colNr(col),d_len(len),d_offset(0),d_byteLen(0),d_int(0),d_val(val){}
         bool isValid() const;
         bool isEof() const;
         const char* getName() const;
         const char* getString() const;
+        CompactToken toCompact( quint32 fileId ) const;
+    };
+
+    class TokenRing
+    {
+        // power-of-two ring buffer used for the lookahead of the lexer and the parser; tokens are moved in and out
+    public:
+        TokenRing():d_head(0),d_count(0) { d_ring.resize(8); }
+        bool isEmpty() const { return d_count == 0; }
+        int size() const { return d_count; }
+        const Token& at( int i ) const { return d_ring[ ( d_head + i ) & ( d_ring.size() - 1 ) ]; }
+        const Token& operator[]( int i ) const { return at(i); }
+        void push_back( Token&& t )
+        {
+            if( d_count == d_ring.size() )
+                grow();
+            d_ring[ ( d_head + d_count++ ) & ( d_ring.size() - 1 ) ] = std::move(t);
+        }
+        void push_back( const Token& t ) { push_back( Token(t) ); }
+        void clear() { d_head = d_count = 0; }
+        Token take_front()
+        {
+            Q_ASSERT( d_count > 0 );
+            Token t = std::move( d_ring[d_head] );
+            d_head = ( d_head + 1 ) & ( d_ring.size() - 1 );
+            d_count--;
+            return t;
+        }
+    private:
+        void grow();
+        QVector<Token> d_ring;
+        int d_head, d_count;
     };
 }
 
+Q_DECLARE_TYPEINFO(Alg::CompactToken, Q_PRIMITIVE_TYPE);
+
 #endif // ALGTOKEN_H
@@ -0,0 +1,269 @@
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "AlgTokenCache.h"
+#include "AlgLexer.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <string.h>
+using namespace Alg;
+
+// The image of a token stream is a header, the fixed size records of all tokens up to and including Eof,
+// and the table of the distinct token values, i.e. d_values + 1 offsets followed by the utf-8 bytes;
+// value 0 is the empty one. All numbers are in the byte order of the machine which wrote the image.
+
+static const char s_magic[4] = { 'A', 'l', 'g', 'T' };
+static const quint32 s_format = 1; // of the image, also identifies the byte order
+
+struct ImageHeader
+{
+    char d_magic[4];
+    quint32 d_format;
+    quint32 d_lexer; // Lexer::Version
+    quint32 d_tokens;
+    quint32 d_values;
+    quint32 d_valueBytes;
+};
+
+struct ImageRecord
+{
+    quint16 d_type;
+    quint16 d_code;
+    quint32 d_lineNr;
+    quint32 d_colNr, d_len;
+    quint32 d_offset, d_byteLen;
+    quint32 d_val; // index in the value table
+};
+
+TokenStream::~TokenStream()
+{
+    d_image.clear(); // refers to the mapping of d_file
+    if( d_file )
+        delete d_file;
+}
+
+bool TokenStream::open(const QByteArray& image, const QString& sourcePath)
+{
+    ImageHeader h;
+    if( image.size() < int(sizeof(h)) )
+        return false;
+    ::memcpy( &h, image.constData(), sizeof(h) );
+    if( ::memcmp( h.d_magic, s_magic, 4 ) != 0 || h.d_format != s_format || h.d_lexer != Lexer::Version ||
+            h.d_tokens == 0 || h.d_values == 0 )
+        return false;
+    const quint64 records = sizeof(h) + quint64(h.d_tokens) * sizeof(ImageRecord);
+    const quint64 offsets = records + ( quint64(h.d_values) + 1 ) * sizeof(quint32);
+    if( offsets + h.d_valueBytes != quint64(image.size()) )
+        return false;
+
+    // the values are interned like the lexer does
+    const char* table = image.constData() + records;
+    const char* bytes = image.constData() + offsets;
+    d_values.resize( h.d_values );
+    quint32 start;
+    ::memcpy( &start, table, sizeof(quint32) );
+    for( quint32 i = 0; i < h.d_values; i++ )
+    {
+        quint32 end;
+        ::memcpy( &end, table + ( i + 1 ) * sizeof(quint32), sizeof(quint32) );
+        if( end < start || end > h.d_valueBytes )
+            return false;
+        if( end > start )
+            d_values[i] = Lexer::getSymbol( bytes + start, end - start );
+        start = end;
+    }
+    d_image = image;
+    d_records = d_image.constData() + sizeof(h);
+    d_count = h.d_tokens;
+    d_sourcePath = sourcePath;
+    d_pos = 0;
+    return at( d_count - 1 ).d_type == Tok_Eof;
+}
+
+Token TokenStream::at(int i) const
+{
+    if( i >= d_count )
+        i = d_count - 1;
+    ImageRecord r;
+    ::memcpy( &r, d_records + i * sizeof(ImageRecord), sizeof(r) );
+    Token t( r.d_type, r.d_lineNr, r.d_colNr, r.d_len,
+             r.d_val < quint32(d_values.size()) ? d_values[r.d_val] : QByteArray() );
+    t.d_code = r.d_code;
+    t.d_offset = r.d_offset;
+    t.d_byteLen = r.d_byteLen;
+    t.d_sourcePath = d_sourcePath;
+    if( t.d_type == Tok_unsigned_integer || t.d_type == Tok_decimal_number )
+        Lexer::decodeNumber( t );
+    return t;
+}
+
+Token TokenStream::next()
+{
+    const Token t = at( d_pos );
+    if( d_pos < d_count )
+        d_pos++;
+    return t;
+}
+
+Token TokenStream::peek(int offset)
+{
+    Q_ASSERT( offset > 0 );
+    return at( d_pos + offset - 1 );
+}
+
+TokenCache::TokenCache(const QString& dir, QObject* parent):QObject(parent),d_dir(dir),d_err(0),
+    d_ignoreComments(true),d_packComments(true)
+{
+}
+
+QString TokenCache::filePath(const QByteArray& utf8) const
+{
+    const QByteArray hash = QCryptographicHash::hash( utf8, QCryptographicHash::Sha1 ).toHex();
+    const int flags = ( d_ignoreComments ? 1 : 0 ) | ( d_packComments ? 2 : 0 );
+    return QDir(d_dir).absoluteFilePath( QString("%1-%2-%3.algtok").arg( QString::fromLatin1(hash) )
+                                         .arg( int(Lexer::Version) ).arg( flags ) );
+}
+
+TokenStream* TokenCache::tokens(const QString& path)
+{
+    QFile in( path );
+    if( !in.open( QIODevice::ReadOnly ) )
+        return 0;
+    return tokens( in.readAll(), path );
+}
+
+TokenStream* TokenCache::tokens(const QByteArray& utf8, const QString& path)
+{
+    const QString cachePath = filePath( utf8 );
+    TokenStream* s = new TokenStream();
+
+    QFile* file = new QFile( cachePath );
+    if( file->open( QIODevice::ReadOnly ) )
+    {
+        QByteArray image;
+        const qint64 size = file->size();
+        const uchar* data = size > 0 ? file->map( 0, size ) : 0;
+        if( data )
+            image = QByteArray::fromRawData( (const char*)data, size );
+        else
+            image = file->readAll();
+        if( s->open( image, path ) )
+        {
+            if( data )
+                s->d_file = file;
+            else
+                delete file;
+            return s;
+        }
+    }
+    delete file;
+
+    Lexer lex;
+    lex.setIgnoreComments( d_ignoreComments );
+    lex.setPackComments( d_packComments );
+    lex.setErrors( d_err );
+    lex.setBuffer( utf8, path );
+    QList<Token> toks;
+    bool clean = true;
+    while( true )
+    {
+        Token t = lex.nextToken();
+        if( t.d_type == Tok_Invalid )
+            clean = false;
+        else if( t.d_type == Tok_unsigned_integer || t.d_type == Tok_decimal_number )
+            clean = clean && Lexer::decodeNumber( t ) == Lexer::NumberOk;
+        toks.append( t );
+        if( t.d_type == Tok_Eof )
+            break;
+    }
+    const QByteArray image = encode( toks );
+    if( clean )
+    {
+        QDir().mkpath( d_dir );
+        QSaveFile out( cachePath );
+        if( out.open( QIODevice::WriteOnly ) && out.write( image ) == image.size() )
+            out.commit();
+        else
+            out.cancelWriting();
+    }
+    const bool ok = s->open( image, path );
+    Q_ASSERT( ok );
+    Q_UNUSED( ok );
+    return s;
+}
+
+QByteArray TokenCache::encode(const QList<Token>& toks)
+{
+    QHash<QByteArray,quint32> index;
+    QList<QByteArray> values;
+    values.append( QByteArray() );
+    quint32 valueBytes = 0;
+
+    ImageHeader h;
+    ::memcpy( h.d_magic, s_magic, 4 );
+    h.d_format = s_format;
+    h.d_lexer = Lexer::Version;
+    h.d_tokens = toks.size();
+
+    QByteArray res;
+    res.reserve( sizeof(h) + toks.size() * sizeof(ImageRecord) );
+    res.append( (const char*)&h, sizeof(h) ); // completed below
+    foreach( const Token& t, toks )
+    {
+        ImageRecord r;
+        r.d_type = t.d_type;
+        r.d_code = t.d_code;
+        r.d_lineNr = t.d_lineNr;
+        r.d_colNr = t.d_colNr;
+        r.d_len = t.d_len;
+        r.d_offset = t.d_offset;
+        r.d_byteLen = t.d_byteLen;
+        r.d_val = 0;
+        if( !t.d_val.isEmpty() )
+        {
+            QHash<QByteArray,quint32>::const_iterator i = index.constFind( t.d_val );
+            if( i == index.constEnd() )
+            {
+                r.d_val = values.size();
+                index.insert( t.d_val, r.d_val );
+                values.append( t.d_val );
+                valueBytes += t.d_val.size();
+            }else
+                r.d_val = i.value();
+        }
+        res.append( (const char*)&r, sizeof(r) );
+    }
+    quint32 off = 0;
+    res.append( (const char*)&off, sizeof(off) );
+    foreach( const QByteArray& v, values )
+    {
+        off += v.size();
+        res.append( (const char*)&off, sizeof(off) );
+    }
+    foreach( const QByteArray& v, values )
+        res.append( v );
+
+    h.d_values = values.size();
+    h.d_valueBytes = valueBytes;
+    ::memcpy( res.data(), &h, sizeof(h) );
+    return res;
+}
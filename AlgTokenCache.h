@@ -0,0 +1,83 @@
+#ifndef ALGTOKENCACHE_H
+#define ALGTOKENCACHE_H
+
+/*
+* Copyright 2020 Rochus Keller <mailto:me@rochus-keller.ch>
+*
+* This file is part of the Algol60 parser library.
+*
+* The following is the license that applies to this copy of the
+* library. For a license to use the library under conditions
+* other than those described here, please email to me@rochus-keller.ch.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QVector>
+#include <Algol/AlgParser.h>
+
+class QFile;
+
+namespace Alg
+{
+    class Errors;
+
+    class TokenStream : public Scanner
+    {
+        // replays the tokens of a source from the binary image written by TokenCache, which is usually
+        // a mapped cache file; the values are interned once when the stream is opened
+    public:
+        ~TokenStream();
+        Token next();
+        Token peek(int offset); // 1 is the token returned by the next call of next()
+        Token at( int i ) const; // the last token is Eof, which is also returned for i beyond
+        int count() const { return d_count; }
+    private:
+        friend class TokenCache;
+        TokenStream():d_file(0),d_records(0),d_count(0),d_pos(0){}
+        bool open( const QByteArray& image, const QString& sourcePath );
+        QByteArray d_image;
+        QFile* d_file; // owned, the image is mapped from it
+        const char* d_records;
+        QVector<QByteArray> d_values;
+        QString d_sourcePath;
+        int d_count, d_pos;
+    };
+
+    class TokenCache : public QObject
+    {
+        // stores the lexed tokens of sources in a directory, one file per content hash, lexer version
+        // and options, so that unchanged sources are not lexed again; only sources without lexer
+        // errors or warnings are stored, so a replay reports nothing the lexer would have reported
+    public:
+        explicit TokenCache( const QString& dir, QObject* parent = 0 );
+
+        // as for the lexer, the dialect is always the detected one
+        void setIgnoreComments( bool b ) { d_ignoreComments = b; }
+        void setPackComments( bool b ) { d_packComments = b; }
+        void setErrors(Errors* p) { d_err = p; } // used when lexing a source not yet in the cache
+
+        // the tokens of the source, from the cache or by lexing it and adding it to the cache;
+        // 0 if the file cannot be read; the caller has to delete the stream
+        TokenStream* tokens( const QString& path );
+        TokenStream* tokens( const QByteArray& utf8, const QString& path );
+        QString filePath( const QByteArray& utf8 ) const; // of the cache entry of the source
+
+        static QByteArray encode( const QList<Token>& ); // the tokens up to and including Eof
+    private:
+        QString d_dir;
+        Errors* d_err;
+        bool d_ignoreComments;
+        bool d_packComments;
+    };
+}
+
+#endif // ALGTOKENCACHE_H
@@ -20,17 +20,27 @@
 HEADERS += \
     $$PWD/AlgErrors.h \
     $$PWD/AlgFileCache.h \
+    $$PWD/AlgFlatTree.h \
     $$PWD/AlgLexer.h \
+    $$PWD/AlgLineIndex.h \
     $$PWD/AlgParser.h \
+    $$PWD/AlgSourceRegistry.h \
     $$PWD/AlgSynTree.h \
+    $$PWD/AlgSymbols.h \
     $$PWD/AlgToken.h \
+    $$PWD/AlgTokenCache.h \
     $$PWD/AlgTokenType.h
 
 SOURCES += \
     $$PWD/AlgErrors.cpp \
     $$PWD/AlgFileCache.cpp \
+    $$PWD/AlgFlatTree.cpp \
     $$PWD/AlgLexer.cpp \
+    $$PWD/AlgLineIndex.cpp \
     $$PWD/AlgParser.cpp \
+    $$PWD/AlgSourceRegistry.cpp \
     $$PWD/AlgSynTree.cpp \
+    $$PWD/AlgSymbols.cpp \
     $$PWD/AlgToken.cpp \
+    $$PWD/AlgTokenCache.cpp \
     $$PWD/AlgTokenType.cpp